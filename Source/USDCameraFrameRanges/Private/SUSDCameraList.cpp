@@ -0,0 +1,239 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SUSDCameraList.h"
+
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+
+namespace USDCameraList
+{
+	const FName NameColumn(TEXT("Name"));
+	const FName StartColumn(TEXT("Start"));
+	const FName EndColumn(TEXT("End"));
+	const FName SamplesColumn(TEXT("Samples"));
+	const FName ActionsColumn(TEXT("Actions"));
+}
+
+class SUSDCameraListRow : public SMultiColumnTableRow<const FUSDCameraRecord*>
+{
+public:
+	SLATE_BEGIN_ARGS(SUSDCameraListRow) {}
+		SLATE_ARGUMENT(TSharedPtr<const FUSDCameraStore>, Store)
+		SLATE_ARGUMENT(const FUSDCameraRecord*, Camera)
+		SLATE_EVENT(FOnUSDCameraAction, OnPreview)
+		SLATE_EVENT(FOnUSDCameraAction, OnDuplicate)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& OwnerTable)
+	{
+		Store = InArgs._Store;
+		Camera = InArgs._Camera;
+		OnPreview = InArgs._OnPreview;
+		OnDuplicate = InArgs._OnDuplicate;
+
+		SMultiColumnTableRow<const FUSDCameraRecord*>::Construct(FSuperRowType::FArguments(), OwnerTable);
+	}
+
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+	{
+		if (ColumnName == USDCameraList::NameColumn)
+		{
+			return SNew(STextBlock)
+				.Text(FText::FromStringView(Store->GetName(*Camera)))
+				.ToolTipText(FText::FromStringView(Store->GetPrimPathString(*Camera)));
+		}
+		// Frames are shown plain like everywhere else in the tool, without grouping separators
+		else if (ColumnName == USDCameraList::StartColumn)
+		{
+			return SNew(STextBlock)
+				.Text(FText::FromString(FString::FromInt(Camera->StartFrame)));
+		}
+		else if (ColumnName == USDCameraList::EndColumn)
+		{
+			return SNew(STextBlock)
+				.Text(FText::FromString(FString::FromInt(Camera->EndFrame)));
+		}
+		else if (ColumnName == USDCameraList::SamplesColumn)
+		{
+			return SNew(STextBlock)
+				.Text(FText::AsNumber(Camera->NumSamples));
+		}
+		else if (ColumnName == USDCameraList::ActionsColumn)
+		{
+			return SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SNew(SButton)
+					.Text(FText::FromString(TEXT("Preview")))
+					.OnClicked_Lambda([this]()
+					{
+						OnPreview.ExecuteIfBound(*Camera);
+						return FReply::Handled();
+					})
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SNew(SButton)
+					.Text(FText::FromString(TEXT("Duplicate")))
+					.OnClicked_Lambda([this]()
+					{
+						OnDuplicate.ExecuteIfBound(*Camera);
+						return FReply::Handled();
+					})
+				];
+		}
+
+		return SNullWidget::NullWidget;
+	}
+
+private:
+	TSharedPtr<const FUSDCameraStore> Store;
+	const FUSDCameraRecord* Camera = nullptr;
+	FOnUSDCameraAction OnPreview;
+	FOnUSDCameraAction OnDuplicate;
+};
+
+void SUSDCameraList::Construct(const FArguments& InArgs)
+{
+	Store = InArgs._Cameras.IsValid() ? InArgs._Cameras : MakeShared<const FUSDCameraStore>();
+	AllCameras = Store->GetAllRecords();
+	OnPreview = InArgs._OnPreview;
+	OnDuplicate = InArgs._OnDuplicate;
+
+	RefreshItems();
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0, 0, 0, 4)
+		[
+			SNew(SSearchBox)
+			.HintText(FText::FromString(TEXT("Filter cameras")))
+			.OnTextChanged(this, &SUSDCameraList::OnFilterTextChanged)
+		]
+		+ SVerticalBox::Slot()
+		.FillHeight(1.0f)
+		[
+			SAssignNew(ListView, SListView<const FUSDCameraRecord*>)
+			.ListItemsSource(&FilteredCameras)
+			.SelectionMode(ESelectionMode::Multi)
+			.OnGenerateRow(this, &SUSDCameraList::OnGenerateRow)
+			.HeaderRow
+			(
+				SNew(SHeaderRow)
+				+ SHeaderRow::Column(USDCameraList::NameColumn)
+				.DefaultLabel(FText::FromString(TEXT("Camera name")))
+				.FillWidth(0.4f)
+				.SortMode(this, &SUSDCameraList::GetColumnSortMode, USDCameraList::NameColumn)
+				.OnSort(this, &SUSDCameraList::OnSortModeChanged)
+				+ SHeaderRow::Column(USDCameraList::StartColumn)
+				.DefaultLabel(FText::FromString(TEXT("Start")))
+				.FillWidth(0.1f)
+				.SortMode(this, &SUSDCameraList::GetColumnSortMode, USDCameraList::StartColumn)
+				.OnSort(this, &SUSDCameraList::OnSortModeChanged)
+				+ SHeaderRow::Column(USDCameraList::EndColumn)
+				.DefaultLabel(FText::FromString(TEXT("End")))
+				.FillWidth(0.1f)
+				.SortMode(this, &SUSDCameraList::GetColumnSortMode, USDCameraList::EndColumn)
+				.OnSort(this, &SUSDCameraList::OnSortModeChanged)
+				+ SHeaderRow::Column(USDCameraList::SamplesColumn)
+				.DefaultLabel(FText::FromString(TEXT("Samples")))
+				.FillWidth(0.1f)
+				.SortMode(this, &SUSDCameraList::GetColumnSortMode, USDCameraList::SamplesColumn)
+				.OnSort(this, &SUSDCameraList::OnSortModeChanged)
+				+ SHeaderRow::Column(USDCameraList::ActionsColumn)
+				.DefaultLabel(FText::FromString(TEXT("Create CineCameraActor")))
+				.FillWidth(0.3f)
+			)
+		]
+	];
+}
+
+TArray<const FUSDCameraRecord*> SUSDCameraList::GetSelectedCameras() const
+{
+	TArray<const FUSDCameraRecord*> Selected;
+	for (const FUSDCameraRecord* Camera : FilteredCameras)
+	{
+		if (ListView->IsItemSelected(Camera))
+		{
+			Selected.Add(Camera);
+		}
+	}
+	return Selected;
+}
+
+TSharedRef<ITableRow> SUSDCameraList::OnGenerateRow(const FUSDCameraRecord* Camera, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SUSDCameraListRow, OwnerTable)
+		.Store(Store)
+		.Camera(Camera)
+		.OnPreview(OnPreview)
+		.OnDuplicate(OnDuplicate);
+}
+
+void SUSDCameraList::OnFilterTextChanged(const FText& InFilterText)
+{
+	FilterText = InFilterText.ToString();
+	RefreshItems();
+}
+
+void SUSDCameraList::OnSortModeChanged(EColumnSortPriority::Type SortPriority, const FName& ColumnId, EColumnSortMode::Type NewSortMode)
+{
+	SortColumn = ColumnId;
+	SortMode = NewSortMode;
+	RefreshItems();
+}
+
+EColumnSortMode::Type SUSDCameraList::GetColumnSortMode(FName ColumnId) const
+{
+	return ColumnId == SortColumn ? SortMode : EColumnSortMode::None;
+}
+
+void SUSDCameraList::RefreshItems()
+{
+	FilteredCameras.Reset(AllCameras.Num());
+	for (const FUSDCameraRecord* Camera : AllCameras)
+	{
+		if (FilterText.IsEmpty() || Store->GetName(*Camera).Contains(FilterText) || Store->GetPrimPathString(*Camera).Contains(FilterText))
+		{
+			FilteredCameras.Add(Camera);
+		}
+	}
+
+	if (SortMode != EColumnSortMode::None)
+	{
+		const bool bAscending = SortMode == EColumnSortMode::Ascending;
+		const FName Column = SortColumn;
+		const FUSDCameraStore& Cameras = *Store;
+		FilteredCameras.StableSort([bAscending, Column, &Cameras](const FUSDCameraRecord& A, const FUSDCameraRecord& B)
+		{
+			const FUSDCameraRecord& First = bAscending ? A : B;
+			const FUSDCameraRecord& Second = bAscending ? B : A;
+
+			if (Column == USDCameraList::StartColumn)
+			{
+				return First.StartFrame < Second.StartFrame;
+			}
+			else if (Column == USDCameraList::EndColumn)
+			{
+				return First.EndFrame < Second.EndFrame;
+			}
+			else if (Column == USDCameraList::SamplesColumn)
+			{
+				return First.NumSamples < Second.NumSamples;
+			}
+			return Cameras.GetName(First).Compare(Cameras.GetName(Second), ESearchCase::IgnoreCase) < 0;
+		});
+	}
+
+	if (ListView.IsValid())
+	{
+		ListView->RequestListRefresh();
+	}
+}
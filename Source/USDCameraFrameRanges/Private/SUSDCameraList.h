@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraStore.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+#include "Widgets/Views/SHeaderRow.h"
+
+DECLARE_DELEGATE_OneParam(FOnUSDCameraAction, const FUSDCameraRecord&);
+
+/**
+ * Virtualized, sortable and filterable list of the cameras of a stage.
+ * Only the rows scrolled into view get widgets, so the tab stays responsive with thousands of cameras. Items point into
+ * the camera store the list keeps alive, nothing is copied per camera.
+ */
+class SUSDCameraList : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SUSDCameraList) {}
+		SLATE_ARGUMENT(TSharedPtr<const FUSDCameraStore>, Cameras)
+		SLATE_EVENT(FOnUSDCameraAction, OnPreview)
+		SLATE_EVENT(FOnUSDCameraAction, OnDuplicate)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	TSharedRef<const FUSDCameraStore> GetStore() const
+	{
+		return Store.ToSharedRef();
+	}
+
+	const TArray<const FUSDCameraRecord*>& GetCameras() const
+	{
+		return AllCameras;
+	}
+
+	/** Selected cameras in display order */
+	TArray<const FUSDCameraRecord*> GetSelectedCameras() const;
+
+private:
+	TSharedRef<ITableRow> OnGenerateRow(const FUSDCameraRecord* Camera, const TSharedRef<STableViewBase>& OwnerTable);
+	void OnFilterTextChanged(const FText& InFilterText);
+	void OnSortModeChanged(EColumnSortPriority::Type SortPriority, const FName& ColumnId, EColumnSortMode::Type NewSortMode);
+	EColumnSortMode::Type GetColumnSortMode(FName ColumnId) const;
+
+	/** Rebuilds the visible items from the filter text and sort column */
+	void RefreshItems();
+
+	TSharedPtr<const FUSDCameraStore> Store;
+	TArray<const FUSDCameraRecord*> AllCameras;
+	TArray<const FUSDCameraRecord*> FilteredCameras;
+	TSharedPtr<SListView<const FUSDCameraRecord*>> ListView;
+
+	FString FilterText;
+	FName SortColumn;
+	EColumnSortMode::Type SortMode = EColumnSortMode::None;
+
+	FOnUSDCameraAction OnPreview;
+	FOnUSDCameraAction OnDuplicate;
+};
@@ -0,0 +1,445 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "USDCameraBaker.h"
+#include "USDCameraFrameRangesAPI.h"
+#include "USDCameraSequenceUtils.h"
+#include "USDCameraStore.h"
+#include "USDStageIndex.h"
+#include "USDSyntheticStage.h"
+#include "USDTimeMapping.h"
+#include "LevelSequence.h"
+#include "MovieScene.h"
+#include "Sections/MovieScene3DTransformSection.h"
+#include "Tracks/MovieScene3DTransformTrack.h"
+#include "UnrealUSDWrapper.h"
+#include "USDMemory.h"
+#include "UObject/Package.h"
+#include "UsdWrappers/SdfPath.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/usd/kind/registry.h"
+#include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/camera.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/usd/usdGeom/xform.h"
+#include "pxr/usd/usdGeom/xformable.h"
+#include "USDIncludesEnd.h"
+
+namespace USDCameraFrameRangesTests
+{
+	namespace Private
+	{
+		const FFrameRate TickResolution(24000, 1);
+
+		ULevelSequence* CreateTransientSequence()
+		{
+			ULevelSequence* LevelSequence = NewObject<ULevelSequence>(GetTransientPackage(), NAME_None, RF_Transient);
+			LevelSequence->Initialize();
+			LevelSequence->GetMovieScene()->SetTickResolutionDirectly(TickResolution);
+			return LevelSequence;
+		}
+
+		TArray<FCameraBakeData> BuildAllBakeData(const UE::FUsdStage& Stage)
+		{
+			const FUSDCameraStore Cameras = FUSDStageIndex::CollectCameras(Stage);
+			return USDCameraBaker::BuildAllBakeData(Stage, Cameras, Cameras.GetAllRecords(), FUSDTimeMapping::FromStage(Stage, TickResolution));
+		}
+
+		/** Binding of the camera component the lens tracks are on, parented to the camera's own binding */
+		FGuid FindComponentBinding(const UMovieScene& MovieScene, const FGuid& CameraBinding)
+		{
+			for (int32 Index = 0; Index < MovieScene.GetPossessableCount(); ++Index)
+			{
+				const FMovieScenePossessable& Possessable = MovieScene.GetPossessable(Index);
+				if (Possessable.GetParent() == CameraBinding)
+				{
+					return Possessable.GetGuid();
+				}
+			}
+			return FGuid();
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDTimeMappingTest, "Plugins.USDCameraFrameRanges.TimeMapping",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDTimeMappingTest::RunTest(const FString& Parameters)
+{
+	using namespace USDCameraFrameRangesTests::Private;
+
+	TestTrue(TEXT("24 is a whole rate"), FUSDTimeMapping::ToFrameRate(24.0) == FFrameRate(24, 1));
+	TestTrue(TEXT("12.5 is kept to the thousandth"), FUSDTimeMapping::ToFrameRate(12.5) == FFrameRate(25, 2));
+	TestTrue(TEXT("23.976 is NTSC film"), FUSDTimeMapping::ToFrameRate(23.976) == FFrameRate(24000, 1001));
+	TestTrue(TEXT("29.97 is NTSC video"), FUSDTimeMapping::ToFrameRate(29.97) == FFrameRate(30000, 1001));
+
+	const FUSDTimeMapping FilmMapping(24.0, TickResolution);
+	TestEqual(TEXT("First time code"), FilmMapping.ToTick(1.0).Value, 1000);
+	TestEqual(TEXT("Negative time code"), FilmMapping.ToTick(-1.0).Value, -1000);
+	TestEqual(TEXT("Sub-frame time code"), FilmMapping.ToTick(1.5).Value, 1500);
+	TestEqual(TEXT("Time code far into a shot"), FilmMapping.ToTick(100000.0).Value, 100000000);
+
+	// 800.8 ticks per time code, so only every fifth time code lands on a whole tick
+	const FUSDTimeMapping NTSCMapping(29.97, TickResolution);
+	TestTrue(TEXT("NTSC time code rate"), NTSCMapping.GetTimeCodeRate() == FFrameRate(30000, 1001));
+	const FFrameTime FirstFrameTime = NTSCMapping.ToFrameTime(1.0);
+	TestEqual(TEXT("NTSC first time code tick"), FirstFrameTime.GetFrame().Value, 800);
+	TestEqual(TEXT("NTSC first time code sub-frame"), FirstFrameTime.GetSubFrame(), 0.8f, 1.e-4f);
+	TestEqual(TEXT("NTSC fifth time code"), NTSCMapping.ToTick(5.0).Value, 4004);
+	TestEqual(TEXT("NTSC time code far into a shot"), NTSCMapping.ToTick(30000.0).Value, 24024000);
+
+	TestTrue(TEXT("Invalid stage falls back to 24"), FUSDTimeMapping::FromStage(UE::FUsdStage(), TickResolution).GetTimeCodeRate() == FFrameRate(24, 1));
+
+	UE::FUsdStage Stage = UnrealUSDWrapper::NewStage();
+	if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+	{
+		return false;
+	}
+	{
+		FScopedUsdAllocs UsdAllocs;
+		pxr::UsdStageRefPtr UsdStage = Stage;
+		UsdStage->SetTimeCodesPerSecond(48.0);
+	}
+	const FUSDTimeMapping StageMapping = FUSDTimeMapping::FromStage(Stage, TickResolution);
+	TestTrue(TEXT("Stage timeCodesPerSecond"), StageMapping.GetTimeCodeRate() == FFrameRate(48, 1));
+	TestEqual(TEXT("Stage time code"), StageMapping.ToTick(1.0).Value, 500);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDCameraTimelineMergeTest, "Plugins.USDCameraFrameRanges.TimelineMerge",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDCameraTimelineMergeTest::RunTest(const FString& Parameters)
+{
+	TArray<double> Times;
+	USDStageIndex::MergeTimes({ 1.0, 3.0, 5.0 }, { 2.0, 3.0, 6.0 }, Times);
+	TestEqual(TEXT("Merged times"), Times, TArray<double>{ 1.0, 2.0, 3.0, 5.0, 6.0 });
+
+	USDStageIndex::MergeTimes({}, { 2.0, 4.0 }, Times);
+	TestEqual(TEXT("Merged with no times"), Times, TArray<double>{ 2.0, 4.0 });
+
+	USDStageIndex::MergeTimes({ 1.0, 2.0 }, { 1.0, 2.0 }, Times);
+	TestEqual(TEXT("Merged with the same times"), Times, TArray<double>{ 1.0, 2.0 });
+
+	FUSDSyntheticStageSettings Settings;
+	Settings.NumPrims = 0;
+	Settings.NumCameras = 2;
+	Settings.NumSamples = 11;
+	Settings.NumBindings = 0;
+	UE::FUsdStage Stage = USDSyntheticStage::Create(Settings);
+	if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+	{
+		return false;
+	}
+
+	{
+		FScopedUsdAllocs UsdAllocs;
+
+		// The rig is keyed on every other time code, all of which its cameras have already. A key between two of them
+		// should only show up in the timeline of the camera below the rig
+		pxr::UsdStageRefPtr UsdStage = Stage;
+		pxr::UsdGeomXformable Rig(UsdStage->GetPrimAtPath(pxr::SdfPath("/World/Rig")));
+		bool bResetsXformStack = false;
+		std::vector<pxr::UsdGeomXformOp> RigOps = Rig.GetOrderedXformOps(&bResetsXformStack);
+		RigOps[0].Set(pxr::GfVec3d(0.0, 5.0, 0.0), pxr::UsdTimeCode(1.5));
+	}
+
+	const FUSDCameraStore Cameras = FUSDStageIndex::CollectCameras(Stage);
+	TestEqual(TEXT("Cameras found"), Cameras.Num(), Settings.NumCameras);
+
+	const FUSDCameraRecord* StaticParentCamera = Cameras.FindRecord(UE::FSdfPath(*USDSyntheticStage::GetCameraPath(0)));
+	const FUSDCameraRecord* RiggedCamera = Cameras.FindRecord(UE::FSdfPath(*USDSyntheticStage::GetCameraPath(1)));
+	if (!TestNotNull(TEXT("Camera under a static parent"), StaticParentCamera) || !TestNotNull(TEXT("Camera under the rig"), RiggedCamera))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Samples of the camera under a static parent"), Cameras.GetTimeSamples(*StaticParentCamera).Num(), Settings.NumSamples);
+	TestEqual(TEXT("Samples of the camera under the rig"), Cameras.GetTimeSamples(*RiggedCamera).Num(), Settings.NumSamples + 1);
+	TestEqual(TEXT("Rig sample merged in order"), Cameras.GetTimeSamples(*RiggedCamera)[1], 1.5);
+	TestEqual(TEXT("Start frame"), RiggedCamera->StartFrame, 1);
+	TestEqual(TEXT("End frame"), RiggedCamera->EndFrame, Settings.NumSamples);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDCameraResyncTest, "Plugins.USDCameraFrameRanges.ResyncBlocks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDCameraResyncTest::RunTest(const FString& Parameters)
+{
+	using namespace USDCameraFrameRangesTests::Private;
+
+	FUSDSyntheticStageSettings Settings;
+	Settings.NumPrims = 0;
+	Settings.NumCameras = 1;
+	Settings.NumSamples = 96;
+	Settings.NumBindings = 0;
+	UE::FUsdStage Stage = USDSyntheticStage::Create(Settings);
+	if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+	{
+		return false;
+	}
+
+	// Without reduction every sample is a key, so the blocks are compared key for key
+	const FCameraKeyReductionSettings Reduction;
+	ULevelSequence* LevelSequence = CreateTransientSequence();
+	UMovieScene& MovieScene = *LevelSequence->GetMovieScene();
+
+	TArray<FCameraBakeData> BakeData = BuildAllBakeData(Stage);
+	USDCameraSequenceUtils::AddSpawnableCameras(*LevelSequence, BakeData, Reduction);
+
+	const FString CameraPath = USDSyntheticStage::GetCameraPath(0);
+	const FGuid CameraBinding = USDCameraBaker::FindPrimBinding(MovieScene, CameraPath);
+	if (!TestTrue(TEXT("Camera binding found"), CameraBinding.IsValid()))
+	{
+		return false;
+	}
+	const FGuid ComponentBinding = FindComponentBinding(MovieScene, CameraBinding);
+	TestTrue(TEXT("Component binding found"), ComponentBinding.IsValid());
+
+	// Six transform channels and the focal length, each of three blocks of 32 samples
+	FCameraResyncStats Stats;
+	BakeData = BuildAllBakeData(Stage);
+	TestTrue(TEXT("Unchanged camera resyncs"), USDCameraBaker::ResyncBakeData(MovieScene, CameraBinding, ComponentBinding, BakeData[0], Reduction, Stats));
+	TestEqual(TEXT("Blocks compared"), Stats.NumBlocks, 7 * 3);
+	TestEqual(TEXT("Blocks changed without an edit"), Stats.NumChangedBlocks, 0);
+	TestEqual(TEXT("Keys written without an edit"), Stats.NumKeysWritten, 0);
+
+	{
+		FScopedUsdAllocs UsdAllocs;
+
+		// Sample 40 is in the second block. Moving the camera along X only touches one channel
+		pxr::UsdStageRefPtr UsdStage = Stage;
+		pxr::UsdGeomXformable Camera(UsdStage->GetPrimAtPath(pxr::SdfPath(TCHAR_TO_ANSI(*CameraPath))));
+		bool bResetsXformStack = false;
+		std::vector<pxr::UsdGeomXformOp> CameraOps = Camera.GetOrderedXformOps(&bResetsXformStack);
+		pxr::GfVec3d Translation;
+		CameraOps[0].Get(&Translation, pxr::UsdTimeCode(41.0));
+		Translation[0] += 50.0;
+		CameraOps[0].Set(Translation, pxr::UsdTimeCode(41.0));
+	}
+
+	Stats = FCameraResyncStats();
+	BakeData = BuildAllBakeData(Stage);
+	TestTrue(TEXT("Edited camera resyncs"), USDCameraBaker::ResyncBakeData(MovieScene, CameraBinding, ComponentBinding, BakeData[0], Reduction, Stats));
+	TestEqual(TEXT("Blocks changed by the edit"), Stats.NumChangedBlocks, 1);
+	TestEqual(TEXT("Keys written for the edit"), Stats.NumKeysWritten, 32);
+
+	// The rewritten block holds the new value
+	UMovieScene3DTransformTrack* TransformTrack = MovieScene.FindTrack<UMovieScene3DTransformTrack>(CameraBinding);
+	UMovieScene3DTransformSection* TransformSection = TransformTrack ? Cast<UMovieScene3DTransformSection>(TransformTrack->GetAllSections()[0]) : nullptr;
+	if (TestNotNull(TEXT("Transform section"), TransformSection))
+	{
+		FMovieSceneDoubleChannel* LocationX = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(0);
+		double Value = 0.0;
+		LocationX->Evaluate(BakeData[0].Frames[40], Value);
+		TestEqual(TEXT("Resynced key"), Value, BakeData[0].TranslationValues[0][40].Value, 1.e-4);
+	}
+
+	Stats = FCameraResyncStats();
+	BakeData = BuildAllBakeData(Stage);
+	USDCameraBaker::ResyncBakeData(MovieScene, CameraBinding, ComponentBinding, BakeData[0], Reduction, Stats);
+	TestEqual(TEXT("Blocks changed once resynced"), Stats.NumChangedBlocks, 0);
+
+	LevelSequence->MarkAsGarbage();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDCameraBakeTest, "Plugins.USDCameraFrameRanges.BakeSyntheticStage",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDCameraBakeTest::RunTest(const FString& Parameters)
+{
+	using namespace USDCameraFrameRangesTests::Private;
+
+	FUSDSyntheticStageSettings Settings;
+	Settings.NumPrims = 200;
+	Settings.NumCameras = 4;
+	Settings.NumSamples = 48;
+	Settings.NumBindings = 100;
+	UE::FUsdStage Stage = USDSyntheticStage::Create(Settings);
+	if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Material bindings"), USDCameraFrameRanges::GetMaterialBindings(Stage).Num(), Settings.NumBindings);
+
+	const TArray<FCameraInfo> Cameras = USDCameraFrameRanges::GetCameras(Stage);
+	TestEqual(TEXT("Cameras found"), Cameras.Num(), Settings.NumCameras);
+
+	ULevelSequence* LevelSequence = CreateTransientSequence();
+	UMovieScene& MovieScene = *LevelSequence->GetMovieScene();
+	TestEqual(TEXT("Cameras baked"), USDCameraFrameRanges::BakeCameras(Stage, Cameras, *LevelSequence), Settings.NumCameras);
+	TestEqual(TEXT("Spawnables"), MovieScene.GetSpawnableCount(), Settings.NumCameras);
+
+	// The last time code is part of the range, the upper bound being exclusive
+	const FUSDTimeMapping TimeMapping = FUSDTimeMapping::FromStage(Stage, TickResolution);
+	const TRange<FFrameNumber> ExpectedRange(TimeMapping.ToTick(1.0), TimeMapping.ToTick(Settings.NumSamples + 1.0));
+	TestTrue(TEXT("Playback range covers every time code"), MovieScene.GetPlaybackRange() == ExpectedRange);
+
+	for (int32 Index = 0; Index < Settings.NumCameras; ++Index)
+	{
+		const FString CameraPath = USDSyntheticStage::GetCameraPath(Index);
+		const FGuid CameraBinding = USDCameraBaker::FindPrimBinding(MovieScene, CameraPath);
+		if (!TestTrue(FString::Printf(TEXT("Binding of %s"), *CameraPath), CameraBinding.IsValid()))
+		{
+			continue;
+		}
+
+		UMovieScene3DTransformTrack* TransformTrack = MovieScene.FindTrack<UMovieScene3DTransformTrack>(CameraBinding);
+		if (!TestNotNull(FString::Printf(TEXT("Transform track of %s"), *CameraPath), TransformTrack))
+		{
+			continue;
+		}
+		TestEqual(FString::Printf(TEXT("Transform sections of %s"), *CameraPath), TransformTrack->GetAllSections().Num(), 1);
+		TestTrue(FString::Printf(TEXT("Section range of %s"), *CameraPath), TransformTrack->GetAllSections()[0]->GetRange() == ExpectedRange);
+
+		// Keys may have been reduced by the project settings, but the first sample is always kept
+		UMovieScene3DTransformSection* TransformSection = Cast<UMovieScene3DTransformSection>(TransformTrack->GetAllSections()[0]);
+		TArrayView<const FFrameNumber> Times = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(0)->GetTimes();
+		if (TestTrue(FString::Printf(TEXT("Keys of %s"), *CameraPath), Times.Num() > 0 && Times.Num() <= Settings.NumSamples))
+		{
+			TestEqual(FString::Printf(TEXT("First key of %s"), *CameraPath), Times[0].Value, ExpectedRange.GetLowerBoundValue().Value);
+		}
+
+		TestTrue(FString::Printf(TEXT("Lens tracks of %s"), *CameraPath), FindComponentBinding(MovieScene, CameraBinding).IsValid());
+	}
+
+	LevelSequence->MarkAsGarbage();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDCameraScanPruningTest, "Plugins.USDCameraFrameRanges.ScanPruning",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDCameraScanPruningTest::RunTest(const FString& Parameters)
+{
+	UE::FUsdStage Stage = UnrealUSDWrapper::NewStage();
+	if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+	{
+		return false;
+	}
+
+	{
+		FScopedUsdAllocs UsdAllocs;
+
+		// Cameras published inside component and subcomponent models, and a gprim with a child the scan may skip
+		pxr::UsdStageRefPtr UsdStage = Stage;
+		pxr::UsdGeomXform Turntable = pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/Turntable"));
+		pxr::UsdModelAPI(Turntable.GetPrim()).SetKind(pxr::KindTokens->component);
+		pxr::UsdGeomCamera::Define(UsdStage, pxr::SdfPath("/Turntable/Camera"));
+
+		pxr::UsdGeomXform Mount = pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/Turntable/Mount"));
+		pxr::UsdModelAPI(Mount.GetPrim()).SetKind(pxr::KindTokens->subcomponent);
+		pxr::UsdGeomCamera::Define(UsdStage, pxr::SdfPath("/Turntable/Mount/Camera"));
+
+		pxr::UsdGeomMesh::Define(UsdStage, pxr::SdfPath("/Turntable/Plate"));
+		pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/Turntable/Plate/Child"));
+	}
+
+	int32 NumVisited = 0;
+	const FUSDCameraStore Cameras = FUSDStageIndex::CollectCameras(Stage, &NumVisited);
+	TestEqual(TEXT("Cameras found in models"), Cameras.Num(), 2);
+	TestNotNull(TEXT("Camera in a component"), Cameras.FindRecord(UE::FSdfPath(TEXT("/Turntable/Camera"))));
+	TestNotNull(TEXT("Camera in a subcomponent"), Cameras.FindRecord(UE::FSdfPath(TEXT("/Turntable/Mount/Camera"))));
+
+	// The pseudo root, the two models, the two cameras and the gprim, but not the prim below the gprim
+	TestEqual(TEXT("Prims visited"), NumVisited, 6);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUSDCameraOrientationTest, "Plugins.USDCameraFrameRanges.CameraOrientation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUSDCameraOrientationTest::RunTest(const FString& Parameters)
+{
+	using namespace USDCameraFrameRangesTests::Private;
+
+	struct FOrientationCase
+	{
+		const TCHAR* Description;
+		bool bZUp;
+		float RotateX;
+		FVector ExpectedForward;
+		FVector ExpectedUp;
+	};
+
+	// USD cameras look down -Z with +Y up, ConvertMatrix flips Y on Z up stages and swaps Y and Z on Y up ones
+	const FOrientationCase Cases[] = {
+		{ TEXT("Identity camera on a Z up stage"), true, 0.0f, FVector(0.0, 0.0, -1.0), FVector(0.0, -1.0, 0.0) },
+		{ TEXT("Camera rotated about X on a Z up stage"), true, 90.0f, FVector(0.0, -1.0, 0.0), FVector(0.0, 0.0, 1.0) },
+		{ TEXT("Identity camera on a Y up stage"), false, 0.0f, FVector(0.0, -1.0, 0.0), FVector(0.0, 0.0, 1.0) },
+		{ TEXT("Camera rotated about X on a Y up stage"), false, 90.0f, FVector(0.0, 0.0, 1.0), FVector(0.0, 1.0, 0.0) },
+	};
+
+	for (const FOrientationCase& Case : Cases)
+	{
+		UE::FUsdStage Stage = UnrealUSDWrapper::NewStage();
+		if (!TestTrue(TEXT("Stage created"), static_cast<bool>(Stage)))
+		{
+			return false;
+		}
+
+		{
+			FScopedUsdAllocs UsdAllocs;
+
+			// Two samples so the camera gets keys as well as its initial transform
+			pxr::UsdStageRefPtr UsdStage = Stage;
+			pxr::UsdGeomSetStageUpAxis(UsdStage, Case.bZUp ? pxr::UsdGeomTokens->z : pxr::UsdGeomTokens->y);
+			pxr::UsdGeomCamera Camera = pxr::UsdGeomCamera::Define(UsdStage, pxr::SdfPath("/Camera"));
+			pxr::UsdGeomXformOp RotateOp = Camera.AddRotateXYZOp();
+			RotateOp.Set(pxr::GfVec3f(Case.RotateX, 0.0f, 0.0f), pxr::UsdTimeCode(1.0));
+			RotateOp.Set(pxr::GfVec3f(Case.RotateX, 0.0f, 0.0f), pxr::UsdTimeCode(2.0));
+		}
+
+		const FCameraKeyReductionSettings Reduction;
+		ULevelSequence* LevelSequence = CreateTransientSequence();
+		UMovieScene& MovieScene = *LevelSequence->GetMovieScene();
+
+		TArray<FCameraBakeData> BakeData = BuildAllBakeData(Stage);
+		if (!TestEqual(Case.Description, BakeData.Num(), 1))
+		{
+			continue;
+		}
+
+		const FQuat InitialRotation = BakeData[0].InitialRotation.Quaternion();
+		TestTrue(FString::Printf(TEXT("%s: initial forward"), Case.Description), InitialRotation.GetForwardVector().Equals(Case.ExpectedForward, 1.e-3));
+		TestTrue(FString::Printf(TEXT("%s: initial up"), Case.Description), InitialRotation.GetUpVector().Equals(Case.ExpectedUp, 1.e-3));
+
+		const FFrameNumber FirstFrame = BakeData[0].Frames[0];
+		USDCameraSequenceUtils::AddSpawnableCameras(*LevelSequence, BakeData, Reduction);
+
+		UMovieScene3DTransformTrack* TransformTrack = MovieScene.FindTrack<UMovieScene3DTransformTrack>(USDCameraBaker::FindPrimBinding(MovieScene, TEXT("/Camera")));
+		UMovieScene3DTransformSection* TransformSection = TransformTrack ? Cast<UMovieScene3DTransformSection>(TransformTrack->GetAllSections()[0]) : nullptr;
+		if (TestNotNull(FString::Printf(TEXT("%s: transform section"), Case.Description), TransformSection))
+		{
+			// Rotation channels are roll, pitch and yaw, after the three location channels
+			double Angles[3] = {};
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(Axis + 3)->Evaluate(FirstFrame, Angles[Axis]);
+			}
+
+			const FQuat BakedRotation = FRotator(Angles[1], Angles[2], Angles[0]).Quaternion();
+			TestTrue(FString::Printf(TEXT("%s: baked forward"), Case.Description), BakedRotation.GetForwardVector().Equals(Case.ExpectedForward, 1.e-3));
+			TestTrue(FString::Printf(TEXT("%s: baked up"), Case.Description), BakedRotation.GetUpVector().Equals(Case.ExpectedUp, 1.e-3));
+		}
+
+		LevelSequence->MarkAsGarbage();
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,735 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraBaker.h"
+
+#include "USDCameraFrameRanges.h"
+#include "USDCameraFrameRangesLog.h"
+#include "USDCameraSampleReader.h"
+#include "USDCameraStore.h"
+#include "USDCameraTransformEvaluator.h"
+#include "USDTimeMapping.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "CineCameraActor.h"
+#include "CineCameraComponent.h"
+#include "MovieScene.h"
+#include "MovieSceneObjectBindingID.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Tracks/MovieScene3DTransformTrack.h"
+#include "Tracks/MovieSceneFloatTrack.h"
+#include "Sections/MovieScene3DTransformSection.h"
+#include "Sections/MovieSceneFloatSection.h"
+#include "UsdWrappers/UsdAttribute.h"
+#include "UsdWrappers/UsdPrim.h"
+#include "UsdWrappers/UsdStage.h"
+
+TRACE_DECLARE_INT_COUNTER(USDCameraFrameRanges_SamplesRead, TEXT("USDCameraFrameRanges/SamplesRead"));
+TRACE_DECLARE_INT_COUNTER(USDCameraFrameRanges_KeysWritten, TEXT("USDCameraFrameRanges/KeysWritten"));
+
+FCameraKeyReductionSettings FCameraKeyReductionSettings::LoadFromConfig()
+{
+	FCameraKeyReductionSettings Settings;
+	if (GConfig)
+	{
+		GConfig->GetBool(TEXT("USDCameraFrameRanges"), TEXT("bReduceKeys"), Settings.bEnabled, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("USDCameraFrameRanges"), TEXT("TranslationKeyTolerance"), Settings.TranslationTolerance, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("USDCameraFrameRanges"), TEXT("RotationKeyTolerance"), Settings.RotationTolerance, GEditorPerProjectIni);
+	}
+	return Settings;
+}
+
+namespace USDCameraBaker
+{
+	namespace Private
+	{
+		struct FLensPropertyDesc
+		{
+			const TCHAR* UsdAttributeName;
+			const TCHAR* PropertyName;
+			const TCHAR* PropertyPath;
+
+			/** Distances get the stage's units converted to centimeters, the same as the USD importer does */
+			bool bIsDistance;
+		};
+
+		/** Indexed by ECameraLensProperty */
+		const FLensPropertyDesc LensProperties[] =
+		{
+			{ TEXT("focalLength"), TEXT("CurrentFocalLength"), TEXT("CurrentFocalLength"), true },
+			{ TEXT("focusDistance"), TEXT("ManualFocusDistance"), TEXT("FocusSettings.ManualFocusDistance"), true },
+			{ TEXT("fStop"), TEXT("CurrentAperture"), TEXT("CurrentAperture"), false },
+			{ TEXT("horizontalAperture"), TEXT("SensorWidth"), TEXT("Filmback.SensorWidth"), true },
+			{ TEXT("verticalAperture"), TEXT("SensorHeight"), TEXT("Filmback.SensorHeight"), true },
+		};
+		static_assert(UE_ARRAY_COUNT(LensProperties) == static_cast<SIZE_T>(ECameraLensProperty::Num), "One entry per lens property");
+
+		/**
+		 * Maps sorted sample times to key ticks. Sub-frame samples keep their own tick, only samples landing on the same
+		 * tick collapse into one key, the last sample wins, so OutSampleIndices holds the sample used for each entry of
+		 * OutFrames.
+		 */
+		void BuildKeyFrames(TArrayView<const double> Times, const FUSDTimeMapping& TimeMapping, TArray<FFrameNumber>& OutFrames, TArray<int32>& OutSampleIndices)
+		{
+			OutFrames.Reset(Times.Num());
+			OutSampleIndices.Reset(Times.Num());
+
+			for (int32 Index = 0; Index < Times.Num(); ++Index)
+			{
+				const FFrameNumber FrameNumber = TimeMapping.ToTick(Times[Index]);
+				if (OutFrames.Num() > 0 && OutFrames.Last() == FrameNumber)
+				{
+					OutSampleIndices.Last() = Index;
+					continue;
+				}
+
+				OutFrames.Add(FrameNumber);
+				OutSampleIndices.Add(Index);
+			}
+		}
+
+		/**
+		 * Evaluates the world transform of the camera at each time. Rotations are unwound against the previous sample so
+		 * consecutive keys never jump by a full turn, which would make Sequencer interpolate the long way round.
+		 */
+		void EvaluateTransforms(const FUSDCameraTransformEvaluator& Evaluator, const UE::FSdfPath& CameraPath, TArrayView<const double> Times,
+			TArray<FVector>& OutLocations, TArray<FRotator>& OutRotations)
+		{
+			OutLocations.Reset(Times.Num());
+			OutRotations.Reset(Times.Num());
+
+			FTransform Transform;
+			for (double Time : Times)
+			{
+				if (!Evaluator.ComputeCameraTransform(CameraPath, Time, Transform))
+				{
+					Transform = FTransform::Identity;
+				}
+
+				FRotator Rotation = Transform.Rotator();
+				if (OutRotations.Num() > 0)
+				{
+					const FRotator& Previous = OutRotations.Last();
+					Rotation.Roll = Previous.Roll + FRotator::NormalizeAxis(Rotation.Roll - Previous.Roll);
+					Rotation.Pitch = Previous.Pitch + FRotator::NormalizeAxis(Rotation.Pitch - Previous.Pitch);
+					Rotation.Yaw = Previous.Yaw + FRotator::NormalizeAxis(Rotation.Yaw - Previous.Yaw);
+				}
+
+				OutLocations.Add(Transform.GetLocation());
+				OutRotations.Add(Rotation);
+			}
+		}
+
+		/** Builds constant keys from GetValue(SampleIndex) for the selected samples */
+		template<typename ChannelValueType, typename GetValueType>
+		void BuildConstantValues(const TArray<int32>& SampleIndices, GetValueType&& GetValue, TArray<ChannelValueType>& OutValues)
+		{
+			OutValues.Reset(SampleIndices.Num());
+
+			for (int32 SampleIndex : SampleIndices)
+			{
+				ChannelValueType& Value = OutValues.Emplace_GetRef(GetValue(SampleIndex));
+				Value.InterpMode = RCIM_Constant;
+			}
+		}
+
+		/**
+		 * Reads the lens attributes of the camera, in Unreal units. Unanimated attributes only get a value, and values
+		 * that aren't positive, e.g. the fStop of 0 USD uses to disable depth of field, are left to the component.
+		 */
+		void BuildLensBakeData(const FUSDCameraTransformEvaluator& Evaluator, const UE::FSdfPath& CameraPath, const FUSDTimeMapping& TimeMapping,
+			FCameraBakeData& BakeData)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::BuildLensBakeData);
+			CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, LensAttributeReads);
+
+			const UE::FUsdPrim Prim = Evaluator.GetStage().GetPrimAtPath(CameraPath);
+			if (!Prim)
+			{
+				return;
+			}
+
+			const double DistanceScale = Evaluator.GetStageInfo().MetersPerUnit * 100.0;
+
+			FUsdScalarSamples Samples;
+			TArray<int32> SampleIndices;
+			for (int32 PropertyIndex = 0; PropertyIndex < static_cast<int32>(ECameraLensProperty::Num); ++PropertyIndex)
+			{
+				const FLensPropertyDesc& Desc = LensProperties[PropertyIndex];
+				FCameraLensBakeData& Lens = BakeData.Lens[PropertyIndex];
+
+				const UE::FUsdAttribute Attribute = Prim.GetAttribute(Desc.UsdAttributeName);
+				if (!USDCameraSampleReader::ReadScalarSamples(Attribute, Samples))
+				{
+					continue;
+				}
+
+				const double Scale = Desc.bIsDistance ? DistanceScale : 1.0;
+
+				double InitialValue = 0.0;
+				if (USDCameraSampleReader::ReadScalarValue(Attribute, 0.0, InitialValue) && InitialValue > 0.0)
+				{
+					Lens.bHasValue = true;
+					Lens.Value = static_cast<float>(InitialValue * Scale);
+				}
+
+				if (Samples.Num() > 1)
+				{
+					BuildKeyFrames(Samples.Times, TimeMapping, Lens.Frames, SampleIndices);
+					BuildConstantValues(SampleIndices, [&Samples, Scale](int32 Index) { return static_cast<float>(Samples.Values[Index] * Scale); }, Lens.Values);
+				}
+			}
+		}
+
+		/**
+		 * Drops the keys within Range the cubic curve through the remaining ones reproduces within Tolerance, then fits
+		 * auto tangents
+		 */
+		void ReduceKeys(FMovieSceneDoubleChannel& Channel, double Tolerance, const FFrameRate& DisplayRate, const TRange<FFrameNumber>& Range)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::ReduceKeys);
+
+			TMovieSceneChannelData<FMovieSceneDoubleValue> ChannelData = Channel.GetData();
+			TArrayView<const FFrameNumber> Times = ChannelData.GetTimes();
+			TArrayView<FMovieSceneDoubleValue> Values = ChannelData.GetValues();
+			for (int32 Index = 0; Index < Times.Num(); ++Index)
+			{
+				if (Range.Contains(Times[Index]))
+				{
+					Values[Index].InterpMode = RCIM_Cubic;
+					Values[Index].TangentMode = RCTM_Auto;
+				}
+			}
+			Channel.AutoSetTangents();
+
+			FKeyDataOptimizationParams Params;
+			Params.Tolerance = static_cast<float>(Tolerance);
+			Params.DisplayRate = DisplayRate;
+			Params.Range = Range;
+			Params.bAutoSetInterpolation = false;
+			Channel.Optimize(Params);
+
+			Channel.AutoSetTangents();
+		}
+
+		FName GetPrimBindingTag(const FString& PrimPath)
+		{
+			return FName(*(TEXT("USDPrim:") + PrimPath));
+		}
+
+		/** Samples a resync compares and rewrites together */
+		constexpr int32 ResyncBlockSize = 32;
+
+		/** Tolerance of a resync of keys that weren't reduced, which should match the samples exactly */
+		constexpr double ResyncTolerance = 1.e-4;
+
+		/** Whether the component already has every static lens value ApplyLensValues would set */
+		bool LensValuesMatch(const UCineCameraComponent& CameraComponent, const FCameraBakeData& BakeData)
+		{
+			auto Matches = [&BakeData](ECameraLensProperty Property, float CurrentValue)
+			{
+				const FCameraLensBakeData& Lens = BakeData.Lens[static_cast<int32>(Property)];
+				return !Lens.bHasValue || FMath::IsNearlyEqual(CurrentValue, Lens.Value, static_cast<float>(ResyncTolerance));
+			};
+
+			const FCameraLensBakeData& FocusDistance = BakeData.Lens[static_cast<int32>(ECameraLensProperty::FocusDistance)];
+			if ((FocusDistance.bHasValue || FocusDistance.Frames.Num() > 0) && CameraComponent.FocusSettings.FocusMethod != ECameraFocusMethod::Manual)
+			{
+				return false;
+			}
+
+			return Matches(ECameraLensProperty::FocalLength, CameraComponent.CurrentFocalLength)
+				&& Matches(ECameraLensProperty::FocusDistance, CameraComponent.FocusSettings.ManualFocusDistance)
+				&& Matches(ECameraLensProperty::FStop, CameraComponent.CurrentAperture)
+				&& Matches(ECameraLensProperty::SensorWidth, CameraComponent.Filmback.SensorWidth)
+				&& Matches(ECameraLensProperty::SensorHeight, CameraComponent.Filmback.SensorHeight);
+		}
+
+		/**
+		 * Rewrites the keys of the channel over the blocks of samples it no longer matches within Tolerance. Keys that
+		 * were baked one per sample are compared one to one, reduced keys by evaluating the curve at the sample times.
+		 * Keys left before the first or after the last sample belong to the first or last block. The section is only
+		 * modified if something changed.
+		 * @param OutChangedRanges Frames of the rewritten keys, one range per run of changed blocks
+		 */
+		template<typename ChannelType, typename ChannelValueType>
+		void ResyncChannel(UMovieSceneSection& Section, ChannelType& Channel, const TArray<FFrameNumber>& Frames, const TArray<ChannelValueType>& Values,
+			bool bKeysWereReduced, double Tolerance, TArray<TRange<FFrameNumber>>& OutChangedRanges, FCameraResyncStats& OutStats)
+		{
+			using FScalarType = decltype(ChannelValueType::Value);
+
+			OutChangedRanges.Reset();
+
+			TMovieSceneChannelData<ChannelValueType> ChannelData = Channel.GetData();
+			if (Frames.Num() == 0)
+			{
+				if (ChannelData.GetTimes().Num() > 0)
+				{
+					Section.Modify();
+					ChannelData.Reset();
+					OutChangedRanges.Add(TRange<FFrameNumber>::All());
+				}
+				return;
+			}
+
+			const int32 NumBlocks = FMath::DivideAndRoundUp(Frames.Num(), ResyncBlockSize);
+
+			// Index of the first key at or after the first sample of each block, the last entry bounds the last block
+			auto GetBlockKeyIndex = [&Frames, NumBlocks](TArrayView<const FFrameNumber> Times, int32 Block)
+			{
+				if (Block == 0)
+				{
+					return 0;
+				}
+				if (Block == NumBlocks)
+				{
+					return Times.Num();
+				}
+				return static_cast<int32>(Algo::LowerBound(Times, Frames[Block * ResyncBlockSize]));
+			};
+
+			TBitArray<> ChangedBlocks(false, NumBlocks);
+			{
+				TArrayView<const FFrameNumber> Times = ChannelData.GetTimes();
+				TArrayView<const ChannelValueType> CurrentValues = ChannelData.GetValues();
+
+				int32 FirstKey = 0;
+				for (int32 Block = 0; Block < NumBlocks; ++Block)
+				{
+					const int32 FirstSample = Block * ResyncBlockSize;
+					const int32 EndSample = FMath::Min(FirstSample + ResyncBlockSize, Frames.Num());
+					const int32 EndKey = GetBlockKeyIndex(Times, Block + 1);
+
+					bool bChanged = false;
+					if (!bKeysWereReduced)
+					{
+						bChanged = EndKey - FirstKey != EndSample - FirstSample;
+						for (int32 Sample = FirstSample, Key = FirstKey; !bChanged && Sample < EndSample; ++Sample, ++Key)
+						{
+							bChanged = Times[Key] != Frames[Sample] || FMath::Abs(CurrentValues[Key].Value - Values[Sample].Value) > Tolerance;
+						}
+					}
+					else
+					{
+						bChanged = (Block == 0 && Times.Num() > 0 && Times[0] < Frames[0])
+							|| (Block == NumBlocks - 1 && Times.Num() > 0 && Times.Last() > Frames.Last());
+						for (int32 Sample = FirstSample; !bChanged && Sample < EndSample; ++Sample)
+						{
+							FScalarType CurrentValue = 0;
+							bChanged = !Channel.Evaluate(Frames[Sample], CurrentValue) || FMath::Abs(CurrentValue - Values[Sample].Value) > Tolerance;
+						}
+					}
+
+					ChangedBlocks[Block] = bChanged;
+					FirstKey = EndKey;
+				}
+			}
+
+			OutStats.NumBlocks += NumBlocks;
+
+			// Runs of changed blocks are rewritten from the last one so the key indices of the earlier runs hold
+			for (int32 EndBlock = NumBlocks; EndBlock > 0; --EndBlock)
+			{
+				if (!ChangedBlocks[EndBlock - 1])
+				{
+					continue;
+				}
+
+				int32 FirstBlock = EndBlock - 1;
+				while (FirstBlock > 0 && ChangedBlocks[FirstBlock - 1])
+				{
+					--FirstBlock;
+				}
+
+				if (OutChangedRanges.Num() == 0)
+				{
+					Section.Modify();
+				}
+
+				const int32 FirstKey = GetBlockKeyIndex(ChannelData.GetTimes(), FirstBlock);
+				const int32 EndKey = GetBlockKeyIndex(ChannelData.GetTimes(), EndBlock);
+				for (int32 Key = EndKey - 1; Key >= FirstKey; --Key)
+				{
+					ChannelData.RemoveKey(Key);
+				}
+
+				const int32 FirstSample = FirstBlock * ResyncBlockSize;
+				const int32 EndSample = FMath::Min(EndBlock * ResyncBlockSize, Frames.Num());
+				for (int32 Sample = FirstSample; Sample < EndSample; ++Sample)
+				{
+					ChannelData.AddKey(Frames[Sample], Values[Sample]);
+				}
+
+				OutChangedRanges.Add(TRange<FFrameNumber>::Inclusive(Frames[FirstSample], Frames[EndSample - 1]));
+				OutStats.NumChangedBlocks += EndBlock - FirstBlock;
+				OutStats.NumKeysWritten += EndSample - FirstSample;
+				USD_CAMERA_FRAME_RANGES_COUNTER_ADD(KeysWritten, EndSample - FirstSample);
+
+				EndBlock = FirstBlock + 1;
+			}
+		}
+	}
+
+	FCameraBakeData BuildBakeData(const FUSDCameraTransformEvaluator& Evaluator, const FUSDCameraStore& Cameras, const FUSDCameraRecord& Camera,
+		const FUSDTimeMapping& TimeMapping)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::BuildBakeData);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, BuildBakeData);
+
+		FCameraBakeData BakeData;
+		BakeData.CameraName = FString(Cameras.GetName(Camera));
+		BakeData.PrimPath = FString(Cameras.GetPrimPathString(Camera));
+		const UE::FSdfPath CameraPath(*BakeData.PrimPath);
+		// The upper bound is exclusive, so the range ends one frame after the last sample for it to be included. A static
+		// camera gets one frame rather than an empty range
+		BakeData.Range = TRange<FFrameNumber>(TimeMapping.ToTick(Camera.StartFrame), TimeMapping.ToTick(Camera.EndFrame + 1));
+
+		FTransform InitialTransform;
+		if (Evaluator.ComputeCameraTransform(CameraPath, 0.0, InitialTransform))
+		{
+			BakeData.bHasInitialLocation = true;
+			BakeData.InitialLocation = InitialTransform.GetLocation();
+			BakeData.bHasInitialRotation = true;
+			BakeData.InitialRotation = InitialTransform.Rotator();
+		}
+
+		const double EvaluateStartSeconds = FPlatformTime::Seconds();
+
+		TArray<FVector> Locations;
+		TArray<FRotator> Rotations;
+		const TArrayView<const double> TimeSamples = Cameras.GetTimeSamples(Camera);
+		Private::EvaluateTransforms(Evaluator, CameraPath, TimeSamples, Locations, Rotations);
+
+		TArray<int32> SampleIndices;
+		Private::BuildKeyFrames(TimeSamples, TimeMapping, BakeData.Frames, SampleIndices);
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Private::BuildConstantValues(SampleIndices, [&Locations, Axis](int32 Index) { return Locations[Index][Axis]; }, BakeData.TranslationValues[Axis]);
+		}
+		Private::BuildConstantValues(SampleIndices, [&Rotations](int32 Index) { return Rotations[Index].Roll; }, BakeData.RotationValues[0]);
+		Private::BuildConstantValues(SampleIndices, [&Rotations](int32 Index) { return Rotations[Index].Pitch; }, BakeData.RotationValues[1]);
+		Private::BuildConstantValues(SampleIndices, [&Rotations](int32 Index) { return Rotations[Index].Yaw; }, BakeData.RotationValues[2]);
+
+		Private::BuildLensBakeData(Evaluator, CameraPath, TimeMapping, BakeData);
+
+		int32 NumSamplesRead = TimeSamples.Num();
+		for (const FCameraLensBakeData& Lens : BakeData.Lens)
+		{
+			NumSamplesRead += Lens.Frames.Num();
+		}
+		USD_CAMERA_FRAME_RANGES_COUNTER_ADD(SamplesRead, NumSamplesRead);
+
+		UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Evaluated %d samples for camera %s in %.2f ms"),
+			TimeSamples.Num(), *BakeData.CameraName, (FPlatformTime::Seconds() - EvaluateStartSeconds) * 1000.0);
+
+		return BakeData;
+	}
+
+	TArray<FCameraBakeData> BuildAllBakeData(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras, TArrayView<const FUSDCameraRecord* const> CamerasToBake,
+		const FUSDTimeMapping& TimeMapping)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::BuildAllBakeData);
+
+		// Cameras sharing a rig share the evaluator's cached rig transforms
+		FUSDCameraTransformEvaluator Evaluator(Stage);
+		TArray<const FUSDCameraRecord*> FoundCameras;
+		FoundCameras.Reserve(CamerasToBake.Num());
+		for (const FUSDCameraRecord* Camera : CamerasToBake)
+		{
+			if (Evaluator.AddCamera(Cameras.GetPrimPath(*Camera)))
+			{
+				FoundCameras.Add(Camera);
+			}
+			else
+			{
+				UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Camera %s is not on the stage"), *FString(Cameras.GetPrimPathString(*Camera)));
+			}
+		}
+
+		TArray<FCameraBakeData> BakeData;
+		BakeData.SetNum(FoundCameras.Num());
+		ParallelFor(FoundCameras.Num(), [&Evaluator, &Cameras, &FoundCameras, &BakeData, &TimeMapping](int32 Index)
+		{
+			BakeData[Index] = BuildBakeData(Evaluator, Cameras, *FoundCameras[Index], TimeMapping);
+		});
+		return BakeData;
+	}
+
+	void ApplyBakeData(UMovieScene& MovieScene, const FGuid& Binding, FCameraBakeData& BakeData, const FCameraKeyReductionSettings& Reduction)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::ApplyBakeData);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, KeyInsertion);
+
+		UMovieScene3DTransformTrack* TransformTrack = MovieScene.AddTrack<UMovieScene3DTransformTrack>(Binding);
+		UMovieScene3DTransformSection* TransformSection = Cast<UMovieScene3DTransformSection>(TransformTrack->CreateNewSection());
+
+		TransformSection->SetRange(BakeData.Range);
+
+		// Channels 0-2 are the location, 3-5 the rotation as roll, pitch and yaw
+		FMovieSceneChannelProxy& ChannelProxy = TransformSection->GetChannelProxy();
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			ChannelProxy.GetChannel<FMovieSceneDoubleChannel>(Axis)->Set(BakeData.Frames, MoveTemp(BakeData.TranslationValues[Axis]));
+			ChannelProxy.GetChannel<FMovieSceneDoubleChannel>(Axis + 3)->Set(BakeData.Frames, MoveTemp(BakeData.RotationValues[Axis]));
+		}
+
+		BakeData.NumKeysBaked = BakeData.Frames.Num() * 6;
+		BakeData.NumKeysKept = BakeData.NumKeysBaked;
+
+		if (Reduction.bEnabled)
+		{
+			BakeData.NumKeysKept = 0;
+			for (int32 ChannelIndex = 0; ChannelIndex < 6; ++ChannelIndex)
+			{
+				FMovieSceneDoubleChannel* Channel = ChannelProxy.GetChannel<FMovieSceneDoubleChannel>(ChannelIndex);
+				Private::ReduceKeys(*Channel, ChannelIndex < 3 ? Reduction.TranslationTolerance : Reduction.RotationTolerance, MovieScene.GetDisplayRate(),
+					TRange<FFrameNumber>::All());
+				BakeData.NumKeysKept += Channel->GetNumKeys();
+			}
+		}
+
+		TransformTrack->AddSection(*TransformSection);
+
+		if (!BakeData.PrimPath.IsEmpty())
+		{
+			const FName Tag = Private::GetPrimBindingTag(BakeData.PrimPath);
+			MovieScene.RemoveTag(Tag);
+			MovieScene.TagBinding(Tag, UE::MovieScene::FFixedObjectBindingID(Binding, MovieSceneSequenceID::Root));
+		}
+
+		USD_CAMERA_FRAME_RANGES_COUNTER_ADD(KeysWritten, BakeData.NumKeysKept);
+	}
+
+	void ApplyLensValues(UCineCameraComponent& CameraComponent, const FCameraBakeData& BakeData)
+	{
+		CameraComponent.Modify();
+
+		auto GetLens = [&BakeData](ECameraLensProperty Property) -> const FCameraLensBakeData&
+		{
+			return BakeData.Lens[static_cast<int32>(Property)];
+		};
+
+		const FCameraLensBakeData& FocalLength = GetLens(ECameraLensProperty::FocalLength);
+		if (FocalLength.bHasValue)
+		{
+			CameraComponent.SetCurrentFocalLength(FocalLength.Value);
+		}
+
+		// The focus distance only drives the camera in manual focus
+		const FCameraLensBakeData& FocusDistance = GetLens(ECameraLensProperty::FocusDistance);
+		if (FocusDistance.bHasValue || FocusDistance.Frames.Num() > 0)
+		{
+			CameraComponent.FocusSettings.FocusMethod = ECameraFocusMethod::Manual;
+			if (FocusDistance.bHasValue)
+			{
+				CameraComponent.FocusSettings.ManualFocusDistance = FocusDistance.Value;
+			}
+		}
+
+		const FCameraLensBakeData& FStop = GetLens(ECameraLensProperty::FStop);
+		if (FStop.bHasValue)
+		{
+			CameraComponent.CurrentAperture = FStop.Value;
+		}
+
+		const FCameraLensBakeData& SensorWidth = GetLens(ECameraLensProperty::SensorWidth);
+		if (SensorWidth.bHasValue)
+		{
+			CameraComponent.Filmback.SensorWidth = SensorWidth.Value;
+		}
+
+		const FCameraLensBakeData& SensorHeight = GetLens(ECameraLensProperty::SensorHeight);
+		if (SensorHeight.bHasValue)
+		{
+			CameraComponent.Filmback.SensorHeight = SensorHeight.Value;
+		}
+	}
+
+	bool ApplyInitialValues(ACineCameraActor& CameraActor, const FCameraBakeData& BakeData)
+	{
+		bool bChanged = false;
+
+		// The transform lives on the root component, which is what the transaction needs to record
+		USceneComponent* RootComponent = CameraActor.GetRootComponent();
+		if (BakeData.bHasInitialLocation && !CameraActor.GetActorLocation().Equals(BakeData.InitialLocation, Private::ResyncTolerance))
+		{
+			RootComponent->Modify();
+			CameraActor.SetActorLocation(BakeData.InitialLocation);
+			bChanged = true;
+		}
+
+		if (BakeData.bHasInitialRotation && !CameraActor.GetActorRotation().Equals(BakeData.InitialRotation, Private::ResyncTolerance))
+		{
+			RootComponent->Modify();
+			CameraActor.SetActorRotation(BakeData.InitialRotation);
+			bChanged = true;
+		}
+
+		UCineCameraComponent* CameraComponent = CameraActor.GetCineCameraComponent();
+		if (CameraComponent && !Private::LensValuesMatch(*CameraComponent, BakeData))
+		{
+			ApplyLensValues(*CameraComponent, BakeData);
+			bChanged = true;
+		}
+
+		return bChanged;
+	}
+
+	bool HasLensAnimation(const FCameraBakeData& BakeData)
+	{
+		for (const FCameraLensBakeData& Lens : BakeData.Lens)
+		{
+			if (Lens.Frames.Num() > 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ApplyLensBakeData(UMovieScene& MovieScene, const FGuid& ComponentBinding, FCameraBakeData& BakeData)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::ApplyLensBakeData);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, KeyInsertion);
+
+		for (int32 PropertyIndex = 0; PropertyIndex < static_cast<int32>(ECameraLensProperty::Num); ++PropertyIndex)
+		{
+			FCameraLensBakeData& Lens = BakeData.Lens[PropertyIndex];
+			if (Lens.Frames.Num() == 0)
+			{
+				continue;
+			}
+
+			const Private::FLensPropertyDesc& Desc = Private::LensProperties[PropertyIndex];
+
+			UMovieSceneFloatTrack* FloatTrack = MovieScene.AddTrack<UMovieSceneFloatTrack>(ComponentBinding);
+			FloatTrack->SetPropertyNameAndPath(Desc.PropertyName, Desc.PropertyPath);
+
+			UMovieSceneFloatSection* FloatSection = Cast<UMovieSceneFloatSection>(FloatTrack->CreateNewSection());
+			FloatSection->SetRange(BakeData.Range);
+			USD_CAMERA_FRAME_RANGES_COUNTER_ADD(KeysWritten, Lens.Frames.Num());
+			FloatSection->GetChannelProxy().GetChannel<FMovieSceneFloatChannel>(0)->Set(MoveTemp(Lens.Frames), MoveTemp(Lens.Values));
+
+			FloatTrack->AddSection(*FloatSection);
+		}
+	}
+
+	FGuid FindPrimBinding(const UMovieScene& MovieScene, const FString& PrimPath)
+	{
+		const FMovieSceneObjectBindingIDs* Bindings = MovieScene.AllTaggedBindings().Find(Private::GetPrimBindingTag(PrimPath));
+		if (!Bindings)
+		{
+			return FGuid();
+		}
+
+		// Tags outlive the bindings they were put on, so only those still in the movie scene count
+		for (const UE::MovieScene::FFixedObjectBindingID& BindingID : Bindings->IDs)
+		{
+			if (MovieScene.FindBinding(BindingID.Guid))
+			{
+				return BindingID.Guid;
+			}
+		}
+		return FGuid();
+	}
+
+	bool ResyncBakeData(UMovieScene& MovieScene, const FGuid& Binding, const FGuid& ComponentBinding, FCameraBakeData& BakeData,
+		const FCameraKeyReductionSettings& Reduction, FCameraResyncStats& OutStats)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraBaker::ResyncBakeData);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, KeyInsertion);
+
+		UMovieScene3DTransformTrack* TransformTrack = MovieScene.FindTrack<UMovieScene3DTransformTrack>(Binding);
+		if (!TransformTrack || TransformTrack->GetAllSections().Num() != 1)
+		{
+			return false;
+		}
+		UMovieScene3DTransformSection* TransformSection = Cast<UMovieScene3DTransformSection>(TransformTrack->GetAllSections()[0]);
+
+		// Nothing is touched until every track the bake data needs is known to be there, and no other lens track is
+		UMovieSceneFloatSection* LensSections[static_cast<int32>(ECameraLensProperty::Num)] = {};
+		if (const FMovieSceneBinding* ComponentMovieSceneBinding = ComponentBinding.IsValid() ? MovieScene.FindBinding(ComponentBinding) : nullptr)
+		{
+			for (UMovieSceneTrack* Track : ComponentMovieSceneBinding->GetTracks())
+			{
+				UMovieSceneFloatTrack* FloatTrack = Cast<UMovieSceneFloatTrack>(Track);
+				if (!FloatTrack)
+				{
+					continue;
+				}
+
+				for (int32 PropertyIndex = 0; PropertyIndex < static_cast<int32>(ECameraLensProperty::Num); ++PropertyIndex)
+				{
+					if (FloatTrack->GetPropertyName() == Private::LensProperties[PropertyIndex].PropertyName)
+					{
+						if (BakeData.Lens[PropertyIndex].Frames.Num() == 0 || FloatTrack->GetAllSections().Num() != 1)
+						{
+							return false;
+						}
+						LensSections[PropertyIndex] = Cast<UMovieSceneFloatSection>(FloatTrack->GetAllSections()[0]);
+					}
+				}
+			}
+		}
+
+		for (int32 PropertyIndex = 0; PropertyIndex < static_cast<int32>(ECameraLensProperty::Num); ++PropertyIndex)
+		{
+			if (BakeData.Lens[PropertyIndex].Frames.Num() > 0 && !LensSections[PropertyIndex])
+			{
+				return false;
+			}
+		}
+
+		if (!TransformSection)
+		{
+			return false;
+		}
+
+		if (TransformSection->GetRange() != BakeData.Range)
+		{
+			TransformSection->Modify();
+			TransformSection->SetRange(BakeData.Range);
+		}
+
+		TArray<TRange<FFrameNumber>> ChangedRanges;
+		FMovieSceneChannelProxy& ChannelProxy = TransformSection->GetChannelProxy();
+		for (int32 ChannelIndex = 0; ChannelIndex < 6; ++ChannelIndex)
+		{
+			const TArray<FMovieSceneDoubleValue>& Values = ChannelIndex < 3 ? BakeData.TranslationValues[ChannelIndex] : BakeData.RotationValues[ChannelIndex - 3];
+			const double ReductionTolerance = ChannelIndex < 3 ? Reduction.TranslationTolerance : Reduction.RotationTolerance;
+
+			FMovieSceneDoubleChannel* Channel = ChannelProxy.GetChannel<FMovieSceneDoubleChannel>(ChannelIndex);
+			Private::ResyncChannel(*TransformSection, *Channel, BakeData.Frames, Values, Reduction.bEnabled,
+				Reduction.bEnabled ? ReductionTolerance : Private::ResyncTolerance, ChangedRanges, OutStats);
+
+			if (Reduction.bEnabled)
+			{
+				for (const TRange<FFrameNumber>& ChangedRange : ChangedRanges)
+				{
+					Private::ReduceKeys(*Channel, ReductionTolerance, MovieScene.GetDisplayRate(), ChangedRange);
+				}
+			}
+		}
+
+		for (int32 PropertyIndex = 0; PropertyIndex < static_cast<int32>(ECameraLensProperty::Num); ++PropertyIndex)
+		{
+			UMovieSceneFloatSection* LensSection = LensSections[PropertyIndex];
+			if (!LensSection)
+			{
+				continue;
+			}
+
+			if (LensSection->GetRange() != BakeData.Range)
+			{
+				LensSection->Modify();
+				LensSection->SetRange(BakeData.Range);
+			}
+
+			const FCameraLensBakeData& Lens = BakeData.Lens[PropertyIndex];
+			FMovieSceneFloatChannel* Channel = LensSection->GetChannelProxy().GetChannel<FMovieSceneFloatChannel>(0);
+			Private::ResyncChannel(*LensSection, *Channel, Lens.Frames, Lens.Values, false, Private::ResyncTolerance, ChangedRanges, OutStats);
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,149 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Channels/MovieSceneDoubleChannel.h"
+#include "Channels/MovieSceneFloatChannel.h"
+
+class FUSDCameraStore;
+struct FUSDCameraRecord;
+class FUSDCameraTransformEvaluator;
+class FUSDTimeMapping;
+class ACineCameraActor;
+class UCineCameraComponent;
+class UMovieScene;
+
+namespace UE
+{
+	class FUsdStage;
+}
+
+/** Optical properties of a USD camera baked onto the CineCameraComponent */
+enum class ECameraLensProperty : uint8
+{
+	FocalLength,
+	FocusDistance,
+	FStop,
+	SensorWidth,
+	SensorHeight,
+
+	Num
+};
+
+/** One lens property in Unreal units. Static properties only have a value, animated ones also get keys */
+struct FCameraLensBakeData
+{
+	bool bHasValue = false;
+	float Value = 0.0f;
+
+	TArray<FFrameNumber> Frames;
+	TArray<FMovieSceneFloatValue> Values;
+};
+
+/** Transform and lens keys of one camera, converted from its USD samples and ready to be committed to the sequence */
+struct FCameraBakeData
+{
+	FString CameraName;
+	/** Source camera, remembered on the baked binding so it can be resynced */
+	FString PrimPath;
+	/** The frames of the camera with the last one included, the exclusive upper bound being the frame after it */
+	TRange<FFrameNumber> Range;
+
+	bool bHasInitialLocation = false;
+	FVector InitialLocation = FVector::ZeroVector;
+	bool bHasInitialRotation = false;
+	FRotator InitialRotation = FRotator::ZeroRotator;
+
+	/** Every transform channel is keyed on these same frames */
+	TArray<FFrameNumber> Frames;
+	TArray<FMovieSceneDoubleValue> TranslationValues[3];
+	TArray<FMovieSceneDoubleValue> RotationValues[3];
+
+	FCameraLensBakeData Lens[static_cast<int32>(ECameraLensProperty::Num)];
+
+	/** Keys over all six channels before and after the optional reduction, filled in by ApplyBakeData */
+	int32 NumKeysBaked = 0;
+	int32 NumKeysKept = 0;
+};
+
+/**
+ * Optional reduction of the baked keys, from the [USDCameraFrameRanges] section of the per project editor settings:
+ *   bReduceKeys=True
+ *   TranslationKeyTolerance=0.01
+ *   RotationKeyTolerance=0.01
+ * Tolerances are in centimeters and degrees.
+ */
+struct FCameraKeyReductionSettings
+{
+	bool bEnabled = false;
+	double TranslationTolerance = 0.01;
+	double RotationTolerance = 0.01;
+
+	static FCameraKeyReductionSettings LoadFromConfig();
+};
+
+/** What a resync rewrote, keys are compared in blocks of consecutive samples */
+struct FCameraResyncStats
+{
+	int32 NumBlocks = 0;
+	int32 NumChangedBlocks = 0;
+	int32 NumKeysWritten = 0;
+	/** Cameras whose actor got a new initial transform or static lens values */
+	int32 NumActorsUpdated = 0;
+};
+
+namespace USDCameraBaker
+{
+	/**
+	 * Evaluates the world transform of the camera once per sample of its timeline and reads its lens attributes. Only
+	 * touches USD data, so it can run on any thread. The camera must have been added to the evaluator
+	 */
+	FCameraBakeData BuildBakeData(const FUSDCameraTransformEvaluator& Evaluator, const FUSDCameraStore& Cameras, const FUSDCameraRecord& Camera,
+		const FUSDTimeMapping& TimeMapping);
+
+	/**
+	 * Evaluates records of the store in parallel. Cameras that aren't on the stage are skipped with a warning, so the
+	 * result may be shorter than CamerasToBake. Only touches USD data
+	 */
+	TArray<FCameraBakeData> BuildAllBakeData(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras, TArrayView<const FUSDCameraRecord* const> CamerasToBake,
+		const FUSDTimeMapping& TimeMapping);
+
+	/**
+	 * Adds a transform track holding the baked keys to the binding, moving the key arrays out of BakeData. With reduction
+	 * enabled the keys become cubic, and those the curve can do without within tolerance are dropped. The binding is
+	 * tagged with the prim path of the camera so FindPrimBinding finds it again. Game thread only
+	 */
+	void ApplyBakeData(UMovieScene& MovieScene, const FGuid& Binding, FCameraBakeData& BakeData, const FCameraKeyReductionSettings& Reduction);
+
+	/** Sets the lens properties at the start of the camera on the component. Game thread only */
+	void ApplyLensValues(UCineCameraComponent& CameraComponent, const FCameraBakeData& BakeData);
+
+	/**
+	 * Moves the actor to the transform of the camera at time 0 and sets the lens properties at its start on its
+	 * component, like a bake does. Only what differs from BakeData gets modified. Game thread only
+	 * @return Whether anything changed
+	 */
+	bool ApplyInitialValues(ACineCameraActor& CameraActor, const FCameraBakeData& BakeData);
+
+	/** Adds a float track per animated lens property to the component binding, moving the keys out of BakeData. Game thread only */
+	void ApplyLensBakeData(UMovieScene& MovieScene, const FGuid& ComponentBinding, FCameraBakeData& BakeData);
+
+	/** Whether any lens property is animated, i.e. whether the component needs a binding of its own */
+	bool HasLensAnimation(const FCameraBakeData& BakeData);
+
+	/** Binding baked from the camera at PrimPath, invalid if there is none in the movie scene */
+	FGuid FindPrimBinding(const UMovieScene& MovieScene, const FString& PrimPath);
+
+	/**
+	 * Brings the tracks a previous bake left on the binding up to date with BakeData, only rewriting the keys of the
+	 * blocks of samples whose values moved by more than the tolerance since. The existing curves are evaluated at the
+	 * new sample times, so this works on reduced keys too. The tracks don't hold the initial transform nor the static lens
+	 * values, which ApplyInitialValues brings up to date on the bound actor. Game thread only
+	 * @param ComponentBinding Binding of the camera component holding the lens tracks, may be invalid without lens animation
+	 * @return false if the tracks don't match what BakeData needs, e.g. a lens property became animated, in which case
+	 *         nothing was changed and the camera needs a full bake
+	 */
+	bool ResyncBakeData(UMovieScene& MovieScene, const FGuid& Binding, const FGuid& ComponentBinding, FCameraBakeData& BakeData,
+		const FCameraKeyReductionSettings& Reduction, FCameraResyncStats& OutStats);
+}
@@ -0,0 +1,269 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraBenchmarkCommandlet.h"
+
+#include "USDCameraFrameRangesAPI.h"
+#include "USDCameraFrameRangesLog.h"
+#include "USDMaterialNameMap.h"
+#include "USDStageIndex.h"
+#include "USDSyntheticStage.h"
+#include "Algo/Count.h"
+#include "Components/StaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformMemory.h"
+#include "LevelSequence.h"
+#include "Materials/Material.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+#include "UsdWrappers/UsdStage.h"
+
+namespace USDCameraBenchmarkCommandlet
+{
+	namespace Private
+	{
+		/** Best time of a phase over the iterations, with the amount of work done per iteration */
+		struct FPhaseResult
+		{
+			FString Name;
+			FString Unit;
+			double BestSeconds = TNumericLimits<double>::Max();
+			int64 NumItems = 0;
+			int64 UsedMemoryDelta = 0;
+
+			void AddIteration(double Seconds, int64 InNumItems, int64 InUsedMemoryDelta)
+			{
+				BestSeconds = FMath::Min(BestSeconds, Seconds);
+				NumItems = InNumItems;
+				UsedMemoryDelta = FMath::Max(UsedMemoryDelta, InUsedMemoryDelta);
+			}
+
+			double GetThroughput() const
+			{
+				return BestSeconds > 0.0 ? NumItems / BestSeconds : 0.0;
+			}
+		};
+
+		int64 GetUsedPhysical()
+		{
+			return static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+		}
+
+		/**
+		 * Stand-ins for the project materials, found through the registry in the editor. The first of them match the
+		 * materials of the synthetic stage once their "M_" prefix is stripped, the rest match nothing
+		 */
+		TArray<FAssetData> CreateProjectMaterials(int32 NumMaterials)
+		{
+			TArray<FAssetData> Materials;
+			Materials.Reserve(NumMaterials);
+			for (int32 Index = 0; Index < NumMaterials; ++Index)
+			{
+				const FString AssetName = FString::Printf(TEXT("M_Material_%d"), Index);
+				Materials.Emplace(FName(FString::Printf(TEXT("/Game/Materials/%s"), *AssetName)), FName(TEXT("/Game/Materials")), FName(*AssetName),
+					UMaterial::StaticClass()->GetClassPathName());
+			}
+			return Materials;
+		}
+
+		bool WriteResults(const FString& OutputPath, const FUSDSyntheticStageSettings& Settings, int32 NumProjectMaterials, const TArray<FPhaseResult>& Phases, int64 PeakUsedPhysical)
+		{
+			TArray<TSharedPtr<FJsonValue>> PhaseValues;
+			for (const FPhaseResult& Phase : Phases)
+			{
+				TSharedRef<FJsonObject> PhaseObject = MakeShared<FJsonObject>();
+				PhaseObject->SetStringField(TEXT("name"), Phase.Name);
+				PhaseObject->SetNumberField(TEXT("seconds"), Phase.BestSeconds);
+				PhaseObject->SetNumberField(TEXT("items"), static_cast<double>(Phase.NumItems));
+				PhaseObject->SetStringField(TEXT("unit"), Phase.Unit);
+				PhaseObject->SetNumberField(TEXT("throughput"), Phase.GetThroughput());
+				PhaseObject->SetNumberField(TEXT("usedMemoryDelta"), static_cast<double>(Phase.UsedMemoryDelta));
+				PhaseValues.Add(MakeShared<FJsonValueObject>(PhaseObject));
+			}
+
+			TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+			Results->SetNumberField(TEXT("prims"), Settings.NumPrims);
+			Results->SetNumberField(TEXT("cameras"), Settings.NumCameras);
+			Results->SetNumberField(TEXT("samples"), Settings.NumSamples);
+			Results->SetNumberField(TEXT("bindings"), Settings.NumBindings);
+			Results->SetNumberField(TEXT("projectMaterials"), NumProjectMaterials);
+			Results->SetNumberField(TEXT("peakUsedPhysical"), static_cast<double>(PeakUsedPhysical));
+			Results->SetArrayField(TEXT("phases"), PhaseValues);
+
+			FString Output;
+			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+			if (!FJsonSerializer::Serialize(Results, Writer))
+			{
+				return false;
+			}
+
+			return FFileHelper::SaveStringToFile(Output, *OutputPath);
+		}
+	}
+}
+
+UUSDCameraBenchmarkCommandlet::UUSDCameraBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UUSDCameraBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace USDCameraBenchmarkCommandlet::Private;
+
+	FUSDSyntheticStageSettings Settings;
+	int32 NumProjectMaterials = 1000;
+	int32 NumIterations = 3;
+	FParse::Value(*Params, TEXT("Prims="), Settings.NumPrims);
+	FParse::Value(*Params, TEXT("Cameras="), Settings.NumCameras);
+	FParse::Value(*Params, TEXT("Samples="), Settings.NumSamples);
+	FParse::Value(*Params, TEXT("Bindings="), Settings.NumBindings);
+	FParse::Value(*Params, TEXT("Materials="), NumProjectMaterials);
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	Settings.NumPrims = FMath::Max(Settings.NumPrims, 0);
+	Settings.NumCameras = FMath::Max(Settings.NumCameras, 0);
+	Settings.NumSamples = FMath::Max(Settings.NumSamples, 1);
+	Settings.NumBindings = FMath::Clamp(Settings.NumBindings, 0, Settings.NumPrims);
+	NumProjectMaterials = FMath::Max(NumProjectMaterials, Settings.GetNumMaterials());
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	FString OutputPath;
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("Generating a stage with %d prims, %d cameras of %d samples and %d material bindings, matched against %d project materials"),
+		Settings.NumPrims, Settings.NumCameras, Settings.NumSamples, Settings.NumBindings, NumProjectMaterials);
+
+	const double GenerateStartSeconds = FPlatformTime::Seconds();
+	UE::FUsdStage Stage = USDSyntheticStage::Create(Settings);
+	if (!Stage)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to create an in memory stage"));
+		return 1;
+	}
+	UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("Generated the stage in %.2f s"), FPlatformTime::Seconds() - GenerateStartSeconds);
+
+	FMaterialNameConvention NameConvention;
+	NameConvention.Prefixes.Add(TEXT("M_"));
+	const TArray<FAssetData> ProjectMaterials = CreateProjectMaterials(NumProjectMaterials);
+	UMaterialInterface* DefaultMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+
+	FPhaseResult ScanPhase{ TEXT("Scan cameras"), TEXT("prims") };
+	FPhaseResult BindingPhase{ TEXT("Collect material bindings"), TEXT("prims") };
+	FPhaseResult NameMapPhase{ TEXT("Build material name map"), TEXT("materials") };
+	FPhaseResult LookupPhase{ TEXT("Look up materials"), TEXT("bindings") };
+	FPhaseResult AssignPhase{ TEXT("Assign materials"), TEXT("components") };
+	FPhaseResult BakePhase{ TEXT("Bake cameras"), TEXT("keys") };
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		// Throughputs are over the prims the scans actually visited, the camera scan pruning every subtree of geometry
+		int32 NumVisited = 0;
+		int64 UsedBefore = GetUsedPhysical();
+		double StartSeconds = FPlatformTime::Seconds();
+		const FUSDCameraStore CameraStore = FUSDStageIndex::CollectCameras(Stage, &NumVisited);
+		ScanPhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, NumVisited, GetUsedPhysical() - UsedBefore);
+
+		if (CameraStore.Num() != Settings.NumCameras)
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Found %d cameras instead of %d"), CameraStore.Num(), Settings.NumCameras);
+			return 1;
+		}
+
+		UsedBefore = GetUsedPhysical();
+		StartSeconds = FPlatformTime::Seconds();
+		const TArray<FMaterialInfo> Bindings = FUSDStageIndex::CollectMaterialBindings(Stage, &NumVisited);
+		BindingPhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, NumVisited, GetUsedPhysical() - UsedBefore);
+
+		if (Bindings.Num() != Settings.NumBindings)
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Found %d material bindings instead of %d"), Bindings.Num(), Settings.NumBindings);
+			return 1;
+		}
+
+		TArray<FAssetData> MaterialsToMap = ProjectMaterials;
+		UsedBefore = GetUsedPhysical();
+		StartSeconds = FPlatformTime::Seconds();
+		const FUSDMaterialNameMap MaterialsByName(NameConvention, MoveTemp(MaterialsToMap));
+		NameMapPhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, ProjectMaterials.Num(), GetUsedPhysical() - UsedBefore);
+
+		TArray<const FAssetData*> FoundMaterials;
+		FoundMaterials.Reserve(Bindings.Num());
+		UsedBefore = GetUsedPhysical();
+		StartSeconds = FPlatformTime::Seconds();
+		for (const FMaterialInfo& Binding : Bindings)
+		{
+			FoundMaterials.Add(MaterialsByName.Find(Binding.MatName));
+		}
+		LookupPhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, Bindings.Num(), GetUsedPhysical() - UsedBefore);
+
+		const int32 NumFound = Algo::CountIf(FoundMaterials, [](const FAssetData* FoundMaterial) { return FoundMaterial != nullptr; });
+		if (NumFound != Bindings.Num())
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Matched %d material bindings instead of %d"), NumFound, Bindings.Num());
+			return 1;
+		}
+
+		// The project materials don't exist on disk, so the components get the default material instead of the match,
+		// which still goes through the same override and render state update as a swap in the editor
+		TArray<UMeshComponent*> MeshComponents;
+		MeshComponents.Reserve(Bindings.Num());
+		for (int32 Index = 0; Index < Bindings.Num(); ++Index)
+		{
+			MeshComponents.Add(NewObject<UStaticMeshComponent>(GetTransientPackage(), NAME_None, RF_Transient));
+		}
+
+		UsedBefore = GetUsedPhysical();
+		StartSeconds = FPlatformTime::Seconds();
+		for (UMeshComponent* MeshComponent : MeshComponents)
+		{
+			MeshComponent->SetMaterial(0, DefaultMaterial);
+		}
+		AssignPhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, MeshComponents.Num(), GetUsedPhysical() - UsedBefore);
+
+		const TArray<FCameraInfo> Cameras = CameraStore.ToCameraInfos();
+
+		// Six transform channels per sample of the merged timeline, lens keys aren't counted
+		int64 NumKeys = 0;
+		for (const FCameraInfo& Camera : Cameras)
+		{
+			NumKeys += 6 * Camera.TimeSamples.Num();
+		}
+
+		// A fresh sequence every time, so each iteration bakes from scratch rather than replacing the previous cameras
+		ULevelSequence* LevelSequence = NewObject<ULevelSequence>(GetTransientPackage(), NAME_None, RF_Transient);
+		LevelSequence->Initialize();
+
+		UsedBefore = GetUsedPhysical();
+		StartSeconds = FPlatformTime::Seconds();
+		USDCameraFrameRanges::BakeCameras(Stage, Cameras, *LevelSequence);
+		BakePhase.AddIteration(FPlatformTime::Seconds() - StartSeconds, NumKeys, GetUsedPhysical() - UsedBefore);
+
+		for (UMeshComponent* MeshComponent : MeshComponents)
+		{
+			MeshComponent->MarkAsGarbage();
+		}
+		LevelSequence->MarkAsGarbage();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	const TArray<FPhaseResult> Phases = { ScanPhase, BindingPhase, NameMapPhase, LookupPhase, AssignPhase, BakePhase };
+	for (const FPhaseResult& Phase : Phases)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("%-28s %10.2f ms %14.0f %s/s %+10.1f MB"), *Phase.Name, Phase.BestSeconds * 1000.0,
+			Phase.GetThroughput(), *Phase.Unit, Phase.UsedMemoryDelta / (1024.0 * 1024.0));
+	}
+
+	const int64 PeakUsedPhysical = static_cast<int64>(FPlatformMemory::GetStats().PeakUsedPhysical);
+	UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("Peak used physical memory: %.1f MB"), PeakUsedPhysical / (1024.0 * 1024.0));
+
+	if (!OutputPath.IsEmpty() && !WriteResults(OutputPath, Settings, NumProjectMaterials, Phases, PeakUsedPhysical))
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to write the results to %s"), *OutputPath);
+		return 1;
+	}
+
+	return 0;
+}
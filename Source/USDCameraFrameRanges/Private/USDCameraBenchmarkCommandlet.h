@@ -0,0 +1,31 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "USDCameraBenchmarkCommandlet.generated.h"
+
+/**
+ * Times the scan, material binding, material matching and bake paths on a synthetic stage generated in memory, so
+ * changes can be measured on a headless machine without any production data:
+ *
+ *   UnrealEditor-Cmd Project.uproject -run=USDCameraBenchmark -nullrhi
+ *     [-Prims=100000] [-Cameras=100] [-Samples=240] [-Bindings=10000] [-Materials=1000] [-Iterations=3] [-Output=/tmp/benchmark.json]
+ *
+ * Prims are cubes grouped under xforms, half of the cameras hang under an animated rig. The bindings are matched by name
+ * against Materials stand-in project materials, then assigned to as many transient mesh components. Each phase reports
+ * its best time over the iterations along with its throughput, the scans counting the prims they actually visited, and
+ * the run reports the peak memory of the process.
+ */
+UCLASS()
+class UUSDCameraBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUSDCameraBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
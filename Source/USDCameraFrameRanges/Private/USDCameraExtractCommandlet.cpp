@@ -0,0 +1,276 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraExtractCommandlet.h"
+
+#include "USDCameraBaker.h"
+#include "USDCameraFrameRangesAPI.h"
+#include "USDCameraFrameRangesLog.h"
+#include "USDCameraSequenceUtils.h"
+#include "USDCameraStore.h"
+#include "USDStageIndex.h"
+#include "USDTimeMapping.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "LevelSequence.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MovieScene.h"
+#include "ObjectTools.h"
+#include "Serialization/JsonSerializer.h"
+#include "UsdWrappers/UsdStage.h"
+
+namespace USDCameraExtractCommandlet
+{
+	namespace Private
+	{
+		struct FFileJob
+		{
+			FString FilePath;
+			FString SequencePackageName;
+			ULevelSequence* Sequence = nullptr;
+			bool bCreatedSequence = false;
+			FFrameRate TickResolution;
+
+			FFrameRate TimeCodeRate;
+			FUSDCameraStore Cameras;
+			TArray<FCameraBakeData> BakeData;
+
+			int32 NumKeys = 0;
+			double ExtractSeconds = 0.0;
+			FString Error;
+		};
+
+		/**
+		 * Sequence name of a file: its base name followed by a hash of its full path. Only depends on the path, so a file
+		 * keeps its sequence whatever else is listed and in whatever order, and files with the same name in different
+		 * folders, or named like sh010_2, can't take each other's sequence
+		 */
+		FString GetSequenceName(const FString& FullFilePath)
+		{
+			const FString BaseName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(FullFilePath));
+			return FString::Printf(TEXT("%s_%08x"), *BaseName, FCrc::StrCrc32(*FullFilePath));
+		}
+
+		/** Files from -Files=A+B and from the lines of -FileList, where empty lines and lines starting with # are skipped */
+		bool GatherFiles(const TMap<FString, FString>& ParamVals, TArray<FString>& OutFiles)
+		{
+			if (const FString* FilesParam = ParamVals.Find(TEXT("Files")))
+			{
+				FilesParam->ParseIntoArray(OutFiles, TEXT("+"));
+			}
+
+			if (const FString* FileListParam = ParamVals.Find(TEXT("FileList")))
+			{
+				TArray<FString> Lines;
+				if (!FFileHelper::LoadFileToStringArray(Lines, **FileListParam))
+				{
+					UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to read the file list %s"), **FileListParam);
+					return false;
+				}
+
+				for (FString& Line : Lines)
+				{
+					Line.TrimStartAndEndInline();
+					if (!Line.IsEmpty() && !Line.StartsWith(TEXT("#")))
+					{
+						OutFiles.Add(MoveTemp(Line));
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * Opens, scans and evaluates the cameras of one file through the same calls the editor bakes with. Only touches
+		 * USD data, so the jobs run in parallel
+		 */
+		void ExtractCameras(FFileJob& Job, bool bLoadPayloads)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraExtractCommandlet::ExtractCameras);
+
+			const double StartSeconds = FPlatformTime::Seconds();
+
+			UE::FUsdStage Stage = USDCameraFrameRanges::OpenStage(Job.FilePath, bLoadPayloads);
+			if (!Stage)
+			{
+				Job.Error = TEXT("Failed to open the stage");
+				return;
+			}
+
+			Job.Cameras = FUSDStageIndex::CollectCameras(Stage);
+
+			const FUSDTimeMapping TimeMapping = FUSDTimeMapping::FromStage(Stage, Job.TickResolution);
+			Job.TimeCodeRate = TimeMapping.GetTimeCodeRate();
+
+			Job.BakeData = USDCameraBaker::BuildAllBakeData(Stage, Job.Cameras, Job.Cameras.GetAllRecords(), TimeMapping);
+
+			Job.ExtractSeconds = FPlatformTime::Seconds() - StartSeconds;
+		}
+
+		/** Adds the cameras to the job's sequence. Game thread only */
+		void BakeIntoSequence(FFileJob& Job, const FCameraKeyReductionSettings& Reduction)
+		{
+			if (Job.bCreatedSequence)
+			{
+				Job.Sequence->GetMovieScene()->SetDisplayRate(Job.TimeCodeRate);
+			}
+
+			Job.NumKeys = USDCameraSequenceUtils::AddSpawnableCameras(*Job.Sequence, Job.BakeData, Reduction);
+		}
+
+		bool WriteSummary(const FString& SummaryPath, const TArray<FFileJob>& Jobs, double TotalSeconds)
+		{
+			int32 NumSucceeded = 0;
+			TArray<TSharedPtr<FJsonValue>> FileValues;
+			for (const FFileJob& Job : Jobs)
+			{
+				TSharedRef<FJsonObject> FileObject = MakeShared<FJsonObject>();
+				FileObject->SetStringField(TEXT("file"), Job.FilePath);
+				FileObject->SetStringField(TEXT("sequence"), Job.SequencePackageName);
+				FileObject->SetBoolField(TEXT("succeeded"), Job.Error.IsEmpty());
+				FileObject->SetStringField(TEXT("error"), Job.Error);
+				FileObject->SetNumberField(TEXT("cameras"), Job.Cameras.Num());
+				FileObject->SetNumberField(TEXT("keys"), Job.NumKeys);
+				FileObject->SetNumberField(TEXT("extractSeconds"), Job.ExtractSeconds);
+				FileValues.Add(MakeShared<FJsonValueObject>(FileObject));
+
+				if (Job.Error.IsEmpty())
+				{
+					++NumSucceeded;
+				}
+			}
+
+			TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+			Summary->SetNumberField(TEXT("succeeded"), NumSucceeded);
+			Summary->SetNumberField(TEXT("failed"), Jobs.Num() - NumSucceeded);
+			Summary->SetNumberField(TEXT("seconds"), TotalSeconds);
+			Summary->SetArrayField(TEXT("files"), FileValues);
+
+			FString Output;
+			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+			if (!FJsonSerializer::Serialize(Summary, Writer))
+			{
+				return false;
+			}
+
+			return FFileHelper::SaveStringToFile(Output, *SummaryPath);
+		}
+	}
+}
+
+UUSDCameraExtractCommandlet::UUSDCameraExtractCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UUSDCameraExtractCommandlet::Main(const FString& Params)
+{
+	using namespace USDCameraExtractCommandlet::Private;
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	TArray<FString> Files;
+	if (!GatherFiles(ParamVals, Files) || Files.Num() == 0)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Usage: -run=USDCameraExtract -Files=A.usd+B.usd | -FileList=Files.txt [-OutputPath=/Game/Path] [-Summary=Summary.json] [-LoadPayloads]"));
+		return 1;
+	}
+
+	const FString* OutputPathParam = ParamVals.Find(TEXT("OutputPath"));
+	FString OutputPath = OutputPathParam ? *OutputPathParam : FString(TEXT("/Game/Cinematics/USDCameras"));
+	OutputPath.RemoveFromEnd(TEXT("/"));
+
+	const FString* SummaryParam = ParamVals.Find(TEXT("Summary"));
+	const FString SummaryPath = SummaryParam ? *SummaryParam : FPaths::ProjectSavedDir() / TEXT("USDCameraExtract.json");
+
+	// Payloads stay unloaded by default, the same as OpenStage, so the output matches what the editor bakes
+	const bool bLoadPayloads = Switches.Contains(TEXT("LoadPayloads"));
+
+	// Sequences are loaded or created up front so the workers know the tick resolution to bake at
+	TArray<FFileJob> Jobs;
+	Jobs.SetNum(Files.Num());
+	TMap<FString, FString> FilePathsBySequence;
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		FFileJob& Job = Jobs[Index];
+		Job.FilePath = FPaths::ConvertRelativePathToFull(Files[Index]);
+		Job.SequencePackageName = OutputPath / GetSequenceName(Job.FilePath);
+
+		// A file listed twice would be baked twice into the same sequence
+		if (const FString* OtherFilePath = FilePathsBySequence.Find(Job.SequencePackageName))
+		{
+			Job.Error = *OtherFilePath == Job.FilePath ? FString(TEXT("The file is listed more than once"))
+				: FString::Printf(TEXT("The sequence name is already used by %s"), **OtherFilePath);
+			continue;
+		}
+		FilePathsBySequence.Add(Job.SequencePackageName, Job.FilePath);
+
+		Job.Sequence = USDCameraSequenceUtils::FindOrCreateLevelSequence(Job.SequencePackageName, Job.bCreatedSequence);
+		if (!Job.Sequence)
+		{
+			Job.Error = TEXT("Failed to load or create the level sequence");
+			continue;
+		}
+		Job.TickResolution = Job.Sequence->GetMovieScene()->GetTickResolution();
+	}
+
+	ParallelFor(Jobs.Num(), [&Jobs, bLoadPayloads](int32 Index)
+	{
+		FFileJob& Job = Jobs[Index];
+		if (Job.Error.IsEmpty())
+		{
+			ExtractCameras(Job, bLoadPayloads);
+		}
+	});
+
+	const FCameraKeyReductionSettings Reduction = FCameraKeyReductionSettings::LoadFromConfig();
+
+	TArray<UPackage*> PackagesToSave;
+	for (FFileJob& Job : Jobs)
+	{
+		if (!Job.Error.IsEmpty())
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("%s: %s"), *Job.FilePath, *Job.Error);
+			continue;
+		}
+
+		BakeIntoSequence(Job, Reduction);
+		PackagesToSave.Add(Job.Sequence->GetPackage());
+
+		UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("%s: baked %d cameras into %s"), *Job.FilePath, Job.BakeData.Num(), *Job.SequencePackageName);
+	}
+
+	if (PackagesToSave.Num() > 0)
+	{
+		USDCameraSequenceUtils::SavePackages(PackagesToSave);
+
+		for (FFileJob& Job : Jobs)
+		{
+			if (Job.Error.IsEmpty() && Job.Sequence->GetPackage()->IsDirty())
+			{
+				Job.Error = TEXT("Failed to save the level sequence");
+				UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("%s: %s"), *Job.FilePath, *Job.Error);
+			}
+		}
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - StartSeconds;
+	if (!WriteSummary(SummaryPath, Jobs, TotalSeconds))
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to write the summary to %s"), *SummaryPath);
+	}
+
+	const bool bAllSucceeded = !Jobs.ContainsByPredicate([](const FFileJob& Job) { return !Job.Error.IsEmpty(); });
+	UE_LOG(LogUSDCameraFrameRanges, Display, TEXT("Processed %d USD files in %.2f s, summary written to %s"), Jobs.Num(), TotalSeconds, *SummaryPath);
+
+	return bAllSucceeded ? 0 : 1;
+}
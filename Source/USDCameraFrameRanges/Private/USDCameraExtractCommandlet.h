@@ -0,0 +1,32 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "USDCameraExtractCommandlet.generated.h"
+
+/**
+ * Bakes the cameras of USD files into level sequences without opening the editor UI, e.g. on render nodes:
+ *
+ *   UnrealEditor-Cmd Project.uproject -run=USDCameraExtract -nullrhi
+ *     -Files=/shots/sh010.usd+/shots/sh020.usd | -FileList=/shots/list.txt
+ *     [-OutputPath=/Game/Cinematics/USDCameras] [-Summary=/tmp/summary.json] [-LoadPayloads]
+ *
+ * Each file gets a sequence under OutputPath named after it and a hash of its full path, e.g. sh010_1a2b3c4d, holding
+ * one spawnable CineCameraActor per camera. Cameras baked by a previous run of the same file are replaced. Payloads stay unloaded unless -LoadPayloads is given, the same default as
+ * USDCameraFrameRanges::OpenStage. Stages are opened, scanned and evaluated in parallel with the baker the editor
+ * uses, the sequences are then filled in on the game thread and saved in one batch. The JSON summary lists the outcome of every file, and the
+ * commandlet returns 1 if any file failed.
+ */
+UCLASS()
+class UUSDCameraExtractCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUSDCameraExtractCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
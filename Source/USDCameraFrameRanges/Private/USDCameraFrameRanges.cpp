@@ -2,18 +2,25 @@
 
 #include "USDCameraFrameRanges.h"
 
+#include "USDCameraFrameRangesLog.h"
 #include "USDCameraFrameRangesStyle.h"
 #include "USDCameraFrameRangesCommands.h"
 #include "LevelEditor.h"
 #include "Widgets/Docking/SDockTab.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Text/STextBlock.h"
+#include "Widgets/Notifications/SProgressBar.h"
+#include "Widgets/Layout/SExpandableArea.h"
+#include "Widgets/Layout/SScrollBox.h"
 #include "ToolMenus.h"
 #include "USDStageActor.h"
 #include "CineCameraActor.h"
+#include "CineCameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Editor.h"
 #include "EditorLevelUtils.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
 
 #include "LevelSequence.h"
 #include "MovieScene.h"
@@ -39,17 +46,54 @@
 #include "pxr/usd/usdShade/shader.h"
 #include "USDIncludesEnd.h"
 #include "AssetRegistry/AssetRegistryModule.h"
-#include "Engine/ObjectLibrary.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "Experimental/Async/AwaitableTask.h"
 #include "Tracks/MovieScene3DTransformTrack.h"
 #include "Sections/MovieScene3DTransformSection.h"
 #include "UObject/SavePackage.h"
+#include "USDCameraBaker.h"
+#include "USDCameraLivePreview.h"
+#include "USDCameraSequenceUtils.h"
+#include "USDCameraStore.h"
+#include "USDCameraTransformEvaluator.h"
+#include "USDMaterialNameMap.h"
+#include "USDTimeMapping.h"
+#include "USDStageIndex.h"
+#include "USDStageScanner.h"
+#include "SUSDCameraList.h"
+#include "Async/ParallelFor.h"
+#include "ScopedTransaction.h"
 
 
 static const FName USDCameraFrameRangesTabName("USDCameraFrameRanges");
 
+DEFINE_LOG_CATEGORY(LogUSDCameraFrameRanges);
+CSV_DEFINE_CATEGORY(USDCameraFrameRanges, true);
+
 #define LOCTEXT_NAMESPACE "FUSDCameraFrameRangesModule"
 
+namespace
+{
+	/** Scans of several stages started together, followed in the tab as one */
+	struct FStageScanBatch
+	{
+		TArray<TSharedRef<FUSDScanProgress>> Progresses;
+		int32 NumPending = 0;
+		bool bCancelled = false;
+
+		int32 GetNumVisited() const
+		{
+			int32 NumVisited = 0;
+			for (const TSharedRef<FUSDScanProgress>& Progress : Progresses)
+			{
+				NumVisited += Progress->NumVisited.load();
+			}
+			return NumVisited;
+		}
+	};
+}
+
 void FUSDCameraFrameRangesModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -78,6 +122,11 @@ void FUSDCameraFrameRangesModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	LivePreview.Reset();
+	StageIndices.Empty();
+	SequenceCache.Empty();
+	MaterialLoadHandle.Reset();
+
 	UToolMenus::UnRegisterStartupCallback(this);
 
 	UToolMenus::UnregisterOwner(this);
@@ -92,425 +141,818 @@ void FUSDCameraFrameRangesModule::ShutdownModule()
 
 TSharedRef<SDockTab> FUSDCameraFrameRangesModule::OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs)
 {
-    TObjectPtr<AUsdStageActor> StageActor = GetUsdStageActor();
+	TSharedRef<SDockTab> Tab = SNew(SDockTab)
+		.TabRole(ETabRole::NomadTab);
 
-    if (!StageActor)
-    {
-        // Handle case when StageActor is not found
-        return SNew(SDockTab)
-            .TabRole(ETabRole::NomadTab)
-            [
-                SNew(SBox)
-                .Padding(20)
-                [
-                    SNew(STextBlock)
-                    .Text(FText::FromString(TEXT("USD Stage Actor not found. Please ensure a USD Stage Actor is present in the scene.")))
-                ]
-            ];
-    }
+	ShowStages(Tab);
 
-    TArray<FCameraInfo> Cameras = GetCamerasFromUSDStage(StageActor);
+	return Tab;
+}
 
-    if (Cameras.Num() == 0)
-    {
-        // Handle case when no cameras are found
-        return SNew(SDockTab)
-            .TabRole(ETabRole::NomadTab)
-            [
-                SNew(SBox)
-                .Padding(20)
-                [
-                    SNew(STextBlock)
-                    .Text(FText::FromString(TEXT("No cameras found in the USD Stage. Please ensure there are cameras in the USD Stage.")))
-                ]
-            ];
-    }
+void FUSDCameraFrameRangesModule::ShowStages(TSharedRef<SDockTab> Tab)
+{
+	TArray<TObjectPtr<AUsdStageActor>> StageActors = GetUsdStageActors();
 
-	TSharedPtr<SEditableTextBox> InputTextBox;
-	InputTextBox = SNew(SEditableTextBox);
-
-    TSharedPtr<SVerticalBox> CameraList = SNew(SVerticalBox);
-
-    CameraList->AddSlot()
-    .Padding(2)
-    [
-        SNew(SHorizontalBox)
-        + SHorizontalBox::Slot()
-        .FillWidth(0.4)
-        [
-            SNew(STextBlock)
-            .Text(FText::FromString(TEXT("Camera name")))
-        ]
-        + SHorizontalBox::Slot()
-        .FillWidth(0.4)
-        [
-            SNew(STextBlock)
-            .Text(FText::FromString("Frame range"))
-        ]
-        + SHorizontalBox::Slot()
-        .AutoWidth()
-        [
-            SNew(STextBlock)
-            .Text(FText::FromString(TEXT("Create CineCameraActor")))
-        ]
-    ];
-
-	CameraList->AddSlot()
-	.Padding(10)
-	[
-		SNew(SHorizontalBox)
-		+SHorizontalBox::Slot()
-		.AutoWidth()
-		[
-			SNew(STextBlock)
-			.Text(FText::FromString(TEXT("Level sequence path:")))
-		]
-		+ SHorizontalBox::Slot()
-		.AutoWidth()
+	if (StageActors.Num() == 0)
+	{
+		Tab->SetContent(
+			SNew(SBox)
+			.Padding(20)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("USD Stage Actor not found. Please ensure a USD Stage Actor is present in the scene.")))
+			]);
+		return;
+	}
+
+	// The tab opens straight away, stages that haven't been indexed yet are scanned in the background
+	TArray<TObjectPtr<AUsdStageActor>> StagesToScan;
+	for (const TObjectPtr<AUsdStageActor>& StageActor : StageActors)
+	{
+		if (!GetStageIndex(StageActor).IsBuilt())
+		{
+			StagesToScan.Add(StageActor);
+		}
+	}
+
+	if (StagesToScan.Num() > 0)
+	{
+		StartStageScan(Tab, StagesToScan);
+	}
+	else
+	{
+		Tab->SetContent(BuildCameraListContent(StageActors));
+	}
+}
+
+void FUSDCameraFrameRangesModule::StartStageScan(TSharedRef<SDockTab> Tab, const TArray<TObjectPtr<AUsdStageActor>>& StageActors)
+{
+	TSharedRef<FStageScanBatch> Batch = MakeShared<FStageScanBatch>();
+
+	// The estimate is only meaningful once every stage has been scanned before
+	int32 EstimatedNumPrims = 0;
+	bool bHasEstimates = true;
+	for (const TObjectPtr<AUsdStageActor>& StageActor : StageActors)
+	{
+		Batch->Progresses.Add(MakeShared<FUSDScanProgress>());
+
+		const int32 StageEstimate = GetStageIndex(StageActor).GetEstimatedNumPrims();
+		bHasEstimates &= StageEstimate > 0;
+		EstimatedNumPrims += StageEstimate;
+	}
+	if (!bHasEstimates)
+	{
+		EstimatedNumPrims = 0;
+	}
+
+	const FText ScanText = StageActors.Num() > 1
+		? FText::FromString(FString::Printf(TEXT("Scanning %d USD Stages for cameras..."), StageActors.Num()))
+		: FText::FromString(TEXT("Scanning the USD Stage for cameras..."));
+
+	Tab->SetContent(
+		SNew(SBox)
+		.Padding(20)
 		[
-			InputTextBox.ToSharedRef()
-		]
-	];
+			SNew(SVerticalBox)
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(STextBlock)
+				.Text(ScanText)
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0, 10)
+			[
+				// Without an estimate from a previous scan the bar just shows activity
+				SNew(SProgressBar)
+				.Percent_Lambda([Batch, EstimatedNumPrims]() -> TOptional<float>
+				{
+					if (EstimatedNumPrims <= 0)
+					{
+						return TOptional<float>();
+					}
+					return FMath::Min(1.0f, static_cast<float>(Batch->GetNumVisited()) / EstimatedNumPrims);
+				})
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(STextBlock)
+				.Text_Lambda([Batch, EstimatedNumPrims]()
+				{
+					return EstimatedNumPrims > 0
+						? FText::FromString(FString::Printf(TEXT("%d / ~%d prims visited"), Batch->GetNumVisited(), EstimatedNumPrims))
+						: FText::FromString(FString::Printf(TEXT("%d prims visited"), Batch->GetNumVisited()));
+				})
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0, 10)
+			.HAlign(HAlign_Left)
+			[
+				SNew(SButton)
+				.Text(FText::FromString(TEXT("Cancel")))
+				.OnClicked_Lambda([Batch]()
+				{
+					for (const TSharedRef<FUSDScanProgress>& Progress : Batch->Progresses)
+					{
+						Progress->bCancelRequested = true;
+					}
+					return FReply::Handled();
+				})
+			]
+		]);
 
+	// Every stage is scanned on its own worker, the tab moves on once the last one is done
+	TWeakPtr<SDockTab> WeakTab = Tab;
+	Batch->NumPending = StageActors.Num();
+	for (int32 Index = 0; Index < StageActors.Num(); ++Index)
+	{
+		GetStageIndex(StageActors[Index]).BuildAsync(Batch->Progresses[Index], [this, WeakTab, Batch](bool bCompleted)
+		{
+			Batch->bCancelled |= !bCompleted;
+			if (--Batch->NumPending > 0)
+			{
+				return;
+			}
 
-    // Loop through Cameras array and create a row widget for each camera
-    for (const FCameraInfo& Camera : Cameras)
-    {
-        CameraList->AddSlot()
-        .Padding(2)
-        [
-            SNew(SHorizontalBox)
-            + SHorizontalBox::Slot()
-            .FillWidth(0.4)
-            [
-                SNew(STextBlock)
-                .Text(FText::FromString(Camera.CameraName))
-            ]
-            + SHorizontalBox::Slot()
-            .FillWidth(0.4)
-            [
-                SNew(STextBlock)
-                .Text(FText::FromString(FString::Printf(TEXT("%d - %d"), Camera.StartFrame, Camera.EndFrame)))
-            ]
-            + SHorizontalBox::Slot()
-            .AutoWidth()
-            [
-                SNew(SButton)
-                .Text(FText::FromString(TEXT("Preview")))
-                // Add functionality for the Preview button
-            ]
-            + SHorizontalBox::Slot()
-            .AutoWidth()
-            [
-                SNew(SButton)
-                .Text(FText::FromString(TEXT("Duplicate")))
-            	.OnClicked_Lambda([this, StageActor, Camera, InputTextBox]()
-            	{
-            		return OnDuplicateButtonClicked(StageActor, Camera, InputTextBox->GetText().ToString());
-            	})
-                // .OnClicked(FOnClicked::CreateRaw(this, &FUSDCameraFrameRangesModule::OnDuplicateButtonClicked, StageActor, Camera, InputTextBox->GetText().ToString()))
-            ]
-        ];
-    }
+			TSharedPtr<SDockTab> PinnedTab = WeakTab.Pin();
+			if (!PinnedTab.IsValid())
+			{
+				return;
+			}
+
+			if (Batch->bCancelled)
+			{
+				PinnedTab->SetContent(
+					SNew(SBox)
+					.Padding(20)
+					[
+						SNew(SVerticalBox)
+						+ SVerticalBox::Slot()
+						.AutoHeight()
+						[
+							SNew(STextBlock)
+							.Text(FText::FromString(TEXT("Scan cancelled.")))
+						]
+						+ SVerticalBox::Slot()
+						.AutoHeight()
+						.Padding(0, 10)
+						.HAlign(HAlign_Left)
+						[
+							SNew(SButton)
+							.Text(FText::FromString(TEXT("Scan again")))
+							.OnClicked_Lambda([this, WeakTab]()
+							{
+								if (TSharedPtr<SDockTab> ScanTab = WeakTab.Pin())
+								{
+									ShowStages(ScanTab.ToSharedRef());
+								}
+								return FReply::Handled();
+							})
+						]
+					]);
+				return;
+			}
 
-	return SNew(SDockTab)
-	.TabRole(ETabRole::NomadTab)
-	[
+			// Stages that got loaded while scanning had their result discarded and are scanned again
+			ShowStages(PinnedTab.ToSharedRef());
+		});
+	}
+}
+
+TSharedRef<SWidget> FUSDCameraFrameRangesModule::BuildCameraListContent(const TArray<TObjectPtr<AUsdStageActor>>& StageActors)
+{
+	TSharedRef<SEditableTextBox> InputTextBox = SNew(SEditableTextBox);
+
+	// Layout, animation and set stages each get a section, so cameras are never mixed up between stages
+	TSharedRef<SScrollBox> StageSections = SNew(SScrollBox);
+	for (const TObjectPtr<AUsdStageActor>& StageActor : StageActors)
+	{
+		TSharedRef<const FUSDCameraStore> Cameras = GetStageIndex(StageActor).GetCameras();
+		const FString RootLayerName = FPaths::GetCleanFilename(StageActor->RootLayer.FilePath);
+
+		StageSections->AddSlot()
+			.Padding(0, 0, 0, 10)
+			[
+				SNew(SExpandableArea)
+				.HeaderContent()
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(FString::Printf(TEXT("%s (%s) - %d cameras"), *StageActor->GetActorLabel(), *RootLayerName, Cameras->Num())))
+				]
+				.BodyContent()
+				[
+					BuildStageContent(StageActor, Cameras, InputTextBox)
+				]
+			];
+	}
+
+	return
 		// Main content of the tab
 		SNew(SVerticalBox) // Use SVerticalBox to hold everything vertically
 		+ SVerticalBox::Slot()
 		.AutoHeight()
-		.Padding(20)
+		.Padding(20, 20, 20, 10)
 		[
-			SNew(SScrollBox)
-			+ SScrollBox::Slot()
+			SNew(SHorizontalBox)
+			+SHorizontalBox::Slot()
+			.AutoWidth()
 			[
-				SNew(SBorder)
-				.Padding(FMargin(20))
-				[
-					CameraList.ToSharedRef()
-				]
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Master sequence path:")))
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			[
+				InputTextBox
 			]
 		]
 		+ SVerticalBox::Slot()
-		.AutoHeight()
-		.Padding(20)
+		.FillHeight(1.0f)
+		.Padding(20, 0, 20, 20)
+		[
+			StageSections
+		];
+}
+
+TSharedRef<SWidget> FUSDCameraFrameRangesModule::BuildStageContent(TObjectPtr<AUsdStageActor> StageActor, TSharedRef<const FUSDCameraStore> Cameras,
+	TSharedRef<SEditableTextBox> InputTextBox)
+{
+	TWeakObjectPtr<AUsdStageActor> WeakStageActor = StageActor;
+
+	TSharedRef<SHorizontalBox> ButtonRow = SNew(SHorizontalBox);
+	TSharedRef<SWidget> ListWidget = SNullWidget::NullWidget;
+
+	if (Cameras->Num() == 0)
+	{
+		// Handle case when no cameras are found
+		ListWidget = SNew(STextBlock)
+			.Text(FText::FromString(TEXT("No cameras found in this USD Stage.")));
+	}
+	else
+	{
+		// The list and the callbacks share the index's store, records are passed around by pointer
+		TSharedPtr<SUSDCameraList> CameraList;
+		ListWidget = SAssignNew(CameraList, SUSDCameraList)
+			.Cameras(Cameras)
+			.OnPreview_Lambda([this, WeakStageActor, Cameras](const FUSDCameraRecord& Camera)
+			{
+				if (AUsdStageActor* Actor = WeakStageActor.Get())
+				{
+					TogglePreview(Actor, Cameras, Camera);
+				}
+			})
+			.OnDuplicate_Lambda([this, WeakStageActor, Cameras, InputTextBox](const FUSDCameraRecord& Camera)
+			{
+				if (AUsdStageActor* Actor = WeakStageActor.Get())
+				{
+					OnDuplicateButtonClicked(Actor, *Cameras, Camera, InputTextBox->GetText().ToString());
+				}
+			});
+
+		ButtonRow->AddSlot()
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.Text(FText::FromString(TEXT("Duplicate all")))
+				.OnClicked_Lambda([this, WeakStageActor, CameraList, InputTextBox]()
+				{
+					AUsdStageActor* Actor = WeakStageActor.Get();
+					if (!Actor)
+					{
+						return FReply::Handled();
+					}
+
+					return OnDuplicateCamerasButtonClicked(Actor, *CameraList->GetStore(), CameraList->GetCameras(), InputTextBox->GetText().ToString());
+				})
+			];
+
+		ButtonRow->AddSlot()
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.Text(FText::FromString(TEXT("Duplicate selected")))
+				.OnClicked_Lambda([this, WeakStageActor, CameraList, InputTextBox]()
+				{
+					AUsdStageActor* Actor = WeakStageActor.Get();
+					if (!Actor)
+					{
+						return FReply::Handled();
+					}
+
+					return OnDuplicateCamerasButtonClicked(Actor, *CameraList->GetStore(), CameraList->GetSelectedCameras(), InputTextBox->GetText().ToString());
+				})
+			];
+
+		ButtonRow->AddSlot()
+			.AutoWidth()
+			.Padding(10, 0, 0, 0)
+			[
+				SNew(SButton)
+				.Text(FText::FromString(TEXT("Resync")))
+				.ToolTipText(FText::FromString(TEXT("Updates the shots of the selected cameras, or of all of them, with the current USD samples")))
+				.OnClicked_Lambda([this, WeakStageActor, CameraList, InputTextBox]()
+				{
+					AUsdStageActor* Actor = WeakStageActor.Get();
+					if (!Actor)
+					{
+						return FReply::Handled();
+					}
+
+					TArray<const FUSDCameraRecord*> Selected = CameraList->GetSelectedCameras();
+					if (Selected.Num() == 0)
+					{
+						Selected = CameraList->GetCameras();
+					}
+					ResyncCameras(Actor->GetUsdStage(), *CameraList->GetStore(), Selected, InputTextBox->GetText().ToString());
+					return FReply::Handled();
+				})
+			];
+	}
+
+	ButtonRow->AddSlot()
+		.AutoWidth()
+		.Padding(10, 0, 0, 0)
 		[
 			// Temporary button to test functionality
 			SNew(SButton)
 			.Text(FText::FromString(TEXT("Material swap")))
-			.OnClicked(FOnClicked::CreateRaw(this, &FUSDCameraFrameRangesModule::OnMaterialSwapButtonClicked, StageActor))
-			
-		]
-	];
+			.OnClicked_Lambda([this, WeakStageActor]()
+			{
+				AUsdStageActor* Actor = WeakStageActor.Get();
+				return Actor ? OnMaterialSwapButtonClicked(Actor) : FReply::Handled();
+			})
+		];
 
+	return SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0, 5)
+		[
+			ButtonRow
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			// The list scrolls on its own inside the scrolling stage sections, rows are generated only for the cameras in view
+			SNew(SBox)
+			.MaxDesiredHeight(400.0f)
+			[
+				SNew(SBorder)
+				.Padding(FMargin(10))
+				[
+					ListWidget
+				]
+			]
+		];
 }
 
+FReply FUSDCameraFrameRangesModule::OnDuplicateButtonClicked(TObjectPtr<AUsdStageActor> StageActor, const FUSDCameraStore& Cameras,
+	const FUSDCameraRecord& Camera, FString LevelSequencePath)
+{
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Duplicate button clicked for camera: %s"), *FString(Cameras.GetName(Camera)));
 
+	const FUSDCameraRecord* CameraToDuplicate = &Camera;
+	DuplicateCameras(StageActor->GetUsdStage(), Cameras, MakeArrayView(&CameraToDuplicate, 1), LevelSequencePath);
 
+	return FReply::Handled();
+}
 
-// TODO add functionality to find the aperture stuff, and add duplicate animation
-FReply FUSDCameraFrameRangesModule::OnDuplicateButtonClicked(TObjectPtr<AUsdStageActor> StageActor, FCameraInfo Camera, FString LevelSequencePath)
+FReply FUSDCameraFrameRangesModule::OnDuplicateCamerasButtonClicked(TObjectPtr<AUsdStageActor> StageActor, const FUSDCameraStore& Cameras,
+	TArrayView<const FUSDCameraRecord* const> CamerasToDuplicate, FString LevelSequencePath)
 {
-	UE_LOG(LogTemp, Log, TEXT("Duplicate button clicked for camera: %s"), *Camera.CameraName);
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Duplicate button clicked for %d cameras"), CamerasToDuplicate.Num());
 
-	UWorld* World =  GEditor->GetEditorWorldContext().World();
-	
-	TObjectPtr<ACineCameraActor> NewCameraActor = World->SpawnActor<ACineCameraActor>();
-	
-	if (!NewCameraActor)
+	if (CamerasToDuplicate.Num() == 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Failed to spawn new CineCameraActor"));
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("No cameras selected to duplicate"));
 		return FReply::Handled();
 	}
-	
-	FString NewLabel = Camera.CameraName + TEXT("_duplicate");
-	NewCameraActor->SetActorLabel(NewLabel);
 
-	UE_LOG(LogTemp, Log, TEXT("New camera created with label: %s"), *NewCameraActor->GetActorLabel());
-	UE_LOG(LogTemp, Log, TEXT("Camera name: %s"), *NewCameraActor->GetName());
-	
-	UE::FVtValue Value;
-	
-	UE_LOG(LogTemp, Log, TEXT("Getting value"));
+	DuplicateCameras(StageActor->GetUsdStage(), Cameras, CamerasToDuplicate, LevelSequencePath);
+
+	return FReply::Handled();
+}
+
+void FUSDCameraFrameRangesModule::DuplicateCameras(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras,
+	TArrayView<const FUSDCameraRecord* const> CamerasToDuplicate, const FString& LevelSequencePath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraFrameRangesModule::DuplicateCameras);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, DuplicateCameras);
 
-	bool bSuccess = Camera.Translation.Get(Value, 0.0);
+	const double StartSeconds = FPlatformTime::Seconds();
 
-	UE_LOG(LogTemp, Log, TEXT("Value received"));
+	// Both package and object paths are accepted, the master is created if there is nothing at that path yet
+	ULevelSequence* MasterSequence = nullptr;
+	if (!LevelSequencePath.IsEmpty())
+	{
+		bool bCreated = false;
+		MasterSequence = FindOrCreateSequence(FPackageName::ObjectPathToPackageName(LevelSequencePath), bCreated);
+	}
 
-	if (bSuccess)
+	if (MasterSequence == nullptr)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Translation value found"));
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("No level sequence found or created at path %s"), *LevelSequencePath);
+	}
+
+	// Without a sequence only the initial transforms get used, the default tick resolution is as good as any
+	const FFrameRate TickResolution = MasterSequence ? MasterSequence->GetMovieScene()->GetTickResolution() : FFrameRate(24000, 1);
+	const FUSDTimeMapping TimeMapping = FUSDTimeMapping::FromStage(Stage, TickResolution);
 
-		pxr::VtValue& PxrValue = Value.GetUsdValue();
-		if (PxrValue.IsHolding<pxr::GfVec3d>())
+	// Cameras sharing a rig share the evaluator's cached rig transforms
+	FUSDCameraTransformEvaluator Evaluator(Stage);
+	for (const FUSDCameraRecord* Camera : CamerasToDuplicate)
+	{
+		if (!Evaluator.AddCamera(Cameras.GetPrimPath(*Camera)))
 		{
-			pxr::GfVec3d Translation = PxrValue.Get<pxr::GfVec3d>();
-		
-			// Convert pxr::GfVec3d to FVector
-			FVector CameraLocation(Translation[0], Translation[2], Translation[1]);
-		
-			// Set the camera location in Unreal Engine
-			NewCameraActor->SetActorLocation(CameraLocation);
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Camera %s is no longer on the stage"), *FString(Cameras.GetName(*Camera)));
+		}
+	}
+
+	// Reading and converting the USD samples doesn't touch any UObject, so every camera is processed concurrently
+	TArray<FCameraBakeData> BakeData;
+	BakeData.SetNum(CamerasToDuplicate.Num());
+	ParallelFor(CamerasToDuplicate.Num(), [&Evaluator, &Cameras, &CamerasToDuplicate, &BakeData, &TimeMapping](int32 Index)
+	{
+		BakeData[Index] = USDCameraBaker::BuildBakeData(Evaluator, Cameras, *CamerasToDuplicate[Index], TimeMapping);
+	});
 
-			UE_LOG(LogTemp, Log, TEXT("Camera actor location set to %f %f %f"), Translation[0], Translation[1], Translation[2]);
+	const double ConvertedSeconds = FPlatformTime::Seconds();
 
-		}
-		else
+	// Spawning actors and editing the movie scene has to happen on the game thread, grouped into a single undo step
+	FScopedTransaction Transaction(LOCTEXT("DuplicateCamerasTransaction", "Duplicate USD Cameras"));
+
+	// Every touched sequence is saved in one batch once all the cameras are baked
+	TArray<UPackage*> PackagesToSave;
+	SpawnDuplicates(Stage, MasterSequence, BakeData, FCameraKeyReductionSettings::LoadFromConfig(), PackagesToSave);
+
+	if (MasterSequence && PackagesToSave.Num() > 0)
+	{
+		PackagesToSave.Add(MasterSequence->GetPackage());
+		if (!USDCameraSequenceUtils::SavePackages(PackagesToSave))
 		{
-			UE_LOG(LogTemp, Warning, TEXT("The translation attribute value is not of type GfVec3d"));
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to save some of the %d sequences of %s"), PackagesToSave.Num(), *MasterSequence->GetPathName());
 		}
 	}
-	else
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Duplicated %d cameras in %.2f ms (%.2f ms converting samples, %d rig transforms cached)"),
+		CamerasToDuplicate.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0, (ConvertedSeconds - StartSeconds) * 1000.0, Evaluator.GetNumCachedMatrices());
+}
+
+void FUSDCameraFrameRangesModule::SpawnDuplicates(const UE::FUsdStage& Stage, ULevelSequence* MasterSequence, TArrayView<FCameraBakeData> BakeData,
+	const FCameraKeyReductionSettings& Reduction, TArray<UPackage*>& OutPackagesToSave)
+{
+	if (MasterSequence)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Failed to get the translation attribute at time 0"));
+		MasterSequence->Modify();
 	}
 
-	bSuccess = Camera.Rotation.Get(Value, 0.0);
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	int32 NumKeysBaked = 0;
+	int32 NumKeysKept = 0;
 
-	if (bSuccess)
+	for (FCameraBakeData& CameraBakeData : BakeData)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Rotation value found"));
+		TObjectPtr<ACineCameraActor> NewCameraActor = World->SpawnActor<ACineCameraActor>();
 
-		pxr::VtValue& PxrValue = Value.GetUsdValue();
-		if (PxrValue.IsHolding<pxr::GfVec3f>())
+		if (!NewCameraActor)
 		{
-			pxr::GfVec3f Rotation = PxrValue.Get<pxr::GfVec3f>();
-		
-			// Convert pxr::GfVec3d to FVector
-			FRotator CameraRotation(Rotation[0], (Rotation[1]*-1)-90, Rotation[2]);
-		
-			// Set the camera location in Unreal Engine
-			NewCameraActor->SetActorRotation(CameraRotation);
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to spawn new CineCameraActor"));
+			continue;
+		}
+
+		FString NewLabel = CameraBakeData.CameraName + TEXT("_duplicate");
+		NewCameraActor->SetActorLabel(NewLabel);
 
-			UE_LOG(LogTemp, Log, TEXT("Camera actor rotation set to %f %f %f"), Rotation[0], (Rotation[1]*-1)-90, Rotation[2]);
+		UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("New camera created with label: %s"), *NewCameraActor->GetActorLabel());
 
+		if (CameraBakeData.bHasInitialLocation)
+		{
+			NewCameraActor->SetActorLocation(CameraBakeData.InitialLocation);
+		}
+		else
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to get the translation attribute of %s at time 0"), *CameraBakeData.CameraName);
+		}
+
+		if (CameraBakeData.bHasInitialRotation)
+		{
+			NewCameraActor->SetActorRotation(CameraBakeData.InitialRotation);
 		}
 		else
 		{
-			UE_LOG(LogTemp, Warning, TEXT("The Rotation attribute value is not of type GfVec3d"));
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to get the rotation attribute of %s at time 0"), *CameraBakeData.CameraName);
+		}
+
+		if (UCineCameraComponent* CameraComponent = NewCameraActor->GetCineCameraComponent())
+		{
+			USDCameraBaker::ApplyLensValues(*CameraComponent, CameraBakeData);
+		}
+
+		if (!MasterSequence)
+		{
+			continue;
+		}
+
+		// Each camera gets a shot of its own frame range, which the master then strings together
+		bool bCreatedShot = false;
+		ULevelSequence* ShotSequence = USDCameraSequenceUtils::FindOrCreateShotSequence(*MasterSequence, Stage, CameraBakeData.PrimPath, bCreatedShot);
+		if (!ShotSequence)
+		{
+			continue;
+		}
+
+		ShotSequence->Modify();
+		if (!bCreatedShot)
+		{
+			USDCameraSequenceUtils::ResetShotSequence(*ShotSequence);
+		}
+
+		const FGuid CameraBinding = AddCameraToLevelSequence(ShotSequence, NewCameraActor, CameraBakeData, Reduction);
+		if (!CameraBinding.IsValid())
+		{
+			continue;
 		}
+
+		USDCameraSequenceUtils::SetShotCamera(*ShotSequence, CameraBinding, CameraBakeData.Range);
+		USDCameraSequenceUtils::AddShotToMaster(*MasterSequence, *ShotSequence, CameraBakeData.Range);
+		OutPackagesToSave.Add(ShotSequence->GetPackage());
+
+		NumKeysBaked += CameraBakeData.NumKeysBaked;
+		NumKeysKept += CameraBakeData.NumKeysKept;
 	}
-	else
+
+	if (Reduction.bEnabled && NumKeysBaked > 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Failed to get the Rotation attribute at time 0"));
+		UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Key reduction kept %d of %d keys (%.1f%%)"), NumKeysKept, NumKeysBaked, 100.0 * NumKeysKept / NumKeysBaked);
 	}
-
-	// CreateCameraLevelSequence(NewCameraActor, StageActor, Camera);
-	AddCameraToLevelSequence(LevelSequencePath, NewCameraActor, StageActor, Camera);
-
-	return FReply::Handled();
 }
 
-FReply FUSDCameraFrameRangesModule::OnMaterialSwapButtonClicked(TObjectPtr<AUsdStageActor> StageActor)
+void FUSDCameraFrameRangesModule::ResyncCameras(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras,
+	TArrayView<const FUSDCameraRecord* const> CamerasToResync, const FString& LevelSequencePath)
 {
-	UE::FUsdStage Stage = StageActor->GetUsdStage();
-	UE::FUsdPrim root = Stage.GetPseudoRoot();
-	TArray<FMaterialInfo> MaterialNames;
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraFrameRangesModule::ResyncCameras);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, ResyncCameras);
 
-	// TArray<UMaterialInstance*>* Materials = GetMaterialInstances();
-	TArray<UMaterial*>* FoundMaterials = GetAllMaterials();
-	
-	TraverseAndCollectMaterials(StageActor, root, MaterialNames);
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	ULevelSequence* MasterSequence = nullptr;
+	if (!LevelSequencePath.IsEmpty())
+	{
+		bool bCreated = false;
+		MasterSequence = FindOrCreateSequence(FPackageName::ObjectPathToPackageName(LevelSequencePath), bCreated);
+	}
 
-	if (MaterialNames.Num() >0 )
+	if (MasterSequence == nullptr)
 	{
-		for (FMaterialInfo Mat : MaterialNames)
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("No level sequence found or created at path %s"), *LevelSequencePath);
+		return;
+	}
+
+	const FUSDTimeMapping TimeMapping = FUSDTimeMapping::FromStage(Stage, MasterSequence->GetMovieScene()->GetTickResolution());
+	TArray<FCameraBakeData> BakeData = USDCameraBaker::BuildAllBakeData(Stage, Cameras, CamerasToResync, TimeMapping);
+
+	FScopedTransaction Transaction(LOCTEXT("ResyncCamerasTransaction", "Resync USD Cameras"));
+
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	const FCameraKeyReductionSettings Reduction = FCameraKeyReductionSettings::LoadFromConfig();
+	FCameraResyncStats Stats;
+	TArray<UPackage*> PackagesToSave;
+	TArray<FCameraBakeData> DuplicateBakeData;
+
+	for (FCameraBakeData& CameraBakeData : BakeData)
+	{
+		bool bCreatedShot = false;
+		ULevelSequence* ShotSequence = USDCameraSequenceUtils::FindOrCreateShotSequence(*MasterSequence, Stage, CameraBakeData.PrimPath, bCreatedShot);
+		if (!ShotSequence)
 		{
-			UE::FUsdPrim CurrentPrim = Stage.GetPrimAtPath(Mat.PrimPath);
-			USceneComponent* GeneratedComponent = StageActor->GetGeneratedComponent(Mat.PrimPath.GetString());
-			
-			if (GeneratedComponent)
-			{
-				UE_LOG(LogTemp, Log, TEXT("ObjName: %s Generated Component name: %s"), *Mat.ObjName, *GeneratedComponent->GetName());
+			continue;
+		}
 
-				// Find the Unreal Material with the same name as the USD material
-				FString MaterialName = Mat.MatName;
-				for (UMaterial* FoundMaterial : *FoundMaterials)
-				{
-					if (MaterialName.Equals(FoundMaterial->GetName()))
-					{
-						UMeshComponent* MeshComponent = Cast<UMeshComponent>(GeneratedComponent);
+		UMovieScene* MovieScene = ShotSequence->GetMovieScene();
+		const FGuid CameraBinding = bCreatedShot ? FGuid() : USDCameraBaker::FindPrimBinding(*MovieScene, CameraBakeData.PrimPath);
 
-						MeshComponent->SetMaterial(0, FoundMaterial);
-						UE_LOG(LogTemp, Log, TEXT("Assigned material: %s to component: %s"), *MaterialName, *MeshComponent->GetName());
-					}
-					else
-					{
-						UE_LOG(LogTemp, Warning, TEXT("Material: %s not found in project"), *MaterialName);
-					}
-				}
+		// Lens tracks are on the possessable of the camera component, parented to the actor's
+		FGuid ComponentBinding;
+		for (int32 Index = 0; CameraBinding.IsValid() && Index < MovieScene->GetPossessableCount(); ++Index)
+		{
+			const FMovieScenePossessable& Possessable = MovieScene->GetPossessable(Index);
+			if (Possessable.GetParent() == CameraBinding)
+			{
+				ComponentBinding = Possessable.GetGuid();
+				break;
 			}
 		}
-	}
-	return FReply::Handled();
-}
 
-// adapted from https://forums.unrealengine.com/t/plugin-get-all-materials-in-current-project/342793/10
-TArray<UMaterial*>* FUSDCameraFrameRangesModule::GetAllMaterials()
-{
-	TArray<UMaterial*>* Assets = new TArray<UMaterial*>();
-
-	// Create a library to load all asset data, not filtered by a specific class
-	UObjectLibrary *lib = UObjectLibrary::CreateLibrary(UObject::StaticClass(), false, true);
-	UE_LOG(LogTemp, Warning, TEXT("Searching for assets in /Game/Materials..."));
-
-	// Load asset data from the specified path
-	lib->LoadAssetDataFromPath(TEXT("/Game/Materials"));
-
-	// Retrieve asset data list
-	TArray<FAssetData> assetData;
-	lib->GetAssetDataList(assetData);
-	UE_LOG(LogTemp, Warning, TEXT("Found %d assets"), assetData.Num());
-
-	// Iterate through all asset data and add to the Assets array
-	for (FAssetData asset : assetData) {
-		UMaterial* obj = Cast<UMaterial>(asset.GetAsset());
-		if (obj) {
-			UE_LOG(LogTemp, Warning, TEXT("Asset: %s, type: %s"), *obj->GetName(), *obj->GetClass()->GetName());
-			Assets->Add(obj);
+		// The initial transform and static lens values are on the duplicated actor rather than in the tracks
+		ACineCameraActor* CameraActor = nullptr;
+		if (CameraBinding.IsValid())
+		{
+			TArray<UObject*, TInlineAllocator<1>> BoundObjects;
+			ShotSequence->LocateBoundObjects(CameraBinding, World, BoundObjects);
+			CameraActor = BoundObjects.Num() > 0 ? Cast<ACineCameraActor>(BoundObjects[0]) : nullptr;
 		}
-	}
 
-	return Assets;
-}
+		if (!CameraActor || !USDCameraBaker::ResyncBakeData(*MovieScene, CameraBinding, ComponentBinding, CameraBakeData, Reduction, Stats))
+		{
+			// A failed resync leaves the bake data as it was, so it is baked from scratch as is below
+			UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("%s can't be resynced, duplicating it again"), *CameraBakeData.CameraName);
+			DuplicateBakeData.Add(MoveTemp(CameraBakeData));
+			continue;
+		}
 
+		if (USDCameraBaker::ApplyInitialValues(*CameraActor, CameraBakeData))
+		{
+			++Stats.NumActorsUpdated;
+		}
 
-void FUSDCameraFrameRangesModule::AddCameraToLevelSequence(FString LevelSequencePath,
-	TObjectPtr<ACineCameraActor> CameraActor, TObjectPtr<AUsdStageActor> StageActor, FCameraInfo Camera)
-{
-	ULevelSequence* LevelSequence = Cast<ULevelSequence>(StaticLoadObject(ULevelSequence::StaticClass(), nullptr, *LevelSequencePath));
+		// The master only needs touching when the shot got longer or shorter
+		if (MovieScene->GetPlaybackRange() != CameraBakeData.Range)
+		{
+			USDCameraSequenceUtils::SetShotRange(*ShotSequence, CameraBakeData.Range);
+			USDCameraSequenceUtils::AddShotToMaster(*MasterSequence, *ShotSequence, CameraBakeData.Range);
+		}
+
+		if (ShotSequence->GetPackage()->IsDirty())
+		{
+			PackagesToSave.Add(ShotSequence->GetPackage());
+		}
+	}
 
-	if (LevelSequence == nullptr)
+	// The cameras duplicated again go into the same undo step and save batch as the resynced ones
+	if (DuplicateBakeData.Num() > 0)
 	{
-		UE_LOG(LogTemp, Error, TEXT("No level sequence found at path %s"), *LevelSequencePath);
-		return;
+		SpawnDuplicates(Stage, MasterSequence, DuplicateBakeData, Reduction, PackagesToSave);
 	}
 
-	FGuid Guid = Cast<UMovieSceneSequence>(LevelSequence)->CreatePossessable(CameraActor);
+	if (MasterSequence->GetPackage()->IsDirty())
+	{
+		PackagesToSave.Add(MasterSequence->GetPackage());
+	}
 
-	if (Guid.IsValid())
+	if (PackagesToSave.Num() > 0 && !USDCameraSequenceUtils::SavePackages(PackagesToSave))
 	{
-		UE_LOG(LogTemp, Log, TEXT("Camera actor added to %s with Guid %s"), *LevelSequencePath, *Guid.ToString());
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to save some of the %d sequences of %s"), PackagesToSave.Num(), *MasterSequence->GetPathName());
 	}
-	else
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Resynced %d cameras in %.2f ms, rewrote %d of %d blocks of samples (%d keys) and updated %d camera actors"),
+		BakeData.Num() - DuplicateBakeData.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0, Stats.NumChangedBlocks, Stats.NumBlocks, Stats.NumKeysWritten,
+		Stats.NumActorsUpdated);
+}
+
+void FUSDCameraFrameRangesModule::TogglePreview(TObjectPtr<AUsdStageActor> StageActor, TSharedRef<const FUSDCameraStore> Cameras, const FUSDCameraRecord& Camera)
+{
+	const bool bWasPreviewing = LivePreview && LivePreview->IsActive() && LivePreview->IsPreviewing(*StageActor, Cameras->GetPrimPath(Camera));
+	LivePreview.Reset();
+
+	if (!bWasPreviewing)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Guid invalid"));
-		return;
+		LivePreview = MakeShared<FUSDCameraLivePreview>(*StageActor, Cameras, Camera, GetStageIndex(StageActor).AsShared());
+		UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Previewing camera %s"), *FString(Cameras->GetName(Camera)));
 	}
+}
 
-	UMovieScene3DTransformTrack* TransformTrack = LevelSequence->MovieScene->AddTrack<UMovieScene3DTransformTrack>(Guid);
-	UMovieScene3DTransformSection* TransformSection = Cast<UMovieScene3DTransformSection>(TransformTrack->CreateNewSection());
+FReply FUSDCameraFrameRangesModule::OnMaterialSwapButtonClicked(TObjectPtr<AUsdStageActor> StageActor)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraFrameRangesModule::OnMaterialSwapButtonClicked);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, MaterialSwap);
 
-	int TicksPerFrame = LevelSequence->MovieScene->GetTickResolution().AsDecimal() / LevelSequence->MovieScene->GetDisplayRate().AsDecimal();
-	TransformSection->SetRange(TRange<FFrameNumber>(FFrameNumber(Camera.StartFrame * TicksPerFrame), FFrameNumber(Camera.EndFrame * TicksPerFrame)));
-	
-	FMovieSceneDoubleChannel* TranslateX = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(0);
-	FMovieSceneDoubleChannel* TranslateY = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(1);
-	FMovieSceneDoubleChannel* TranslateZ = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(2);
-
-	FMovieSceneDoubleChannel* RotateX = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(3);
-	FMovieSceneDoubleChannel* RotateY = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(4);
-	FMovieSceneDoubleChannel* RotateZ = TransformSection->GetChannelProxy().GetChannel<FMovieSceneDoubleChannel>(5);
-
-	UE::FVtValue UsdValue;
-	for (double Time : Camera.TransTimeSamples)
-	{		
-		int KeyInt = static_cast<int>(Time);
-		FFrameNumber FrameNumber = FFrameNumber(KeyInt * TicksPerFrame);
-		if (Camera.Translation.Get(UsdValue, Time))
-		{
-			pxr::VtValue PxrValue = UsdValue.GetUsdValue();
-			if (PxrValue.IsHolding<pxr::GfVec3d>())
-			{
-				pxr::GfVec3d Translation = PxrValue.Get<pxr::GfVec3d>();
-				TranslateX->AddConstantKey(FrameNumber, Translation[0]);
-				TranslateY->AddConstantKey(FrameNumber, Translation[2]);
-				TranslateZ->AddConstantKey(FrameNumber, Translation[1]);
-				// UE_LOG(LogTemp, Log, TEXT("Added translation key at time %d: (%f, %f, %f)"), KeyInt, Translation[0], Translation[2], Translation[1]);
-			}
-			else
-			{
-				UE_LOG(LogTemp, Error, TEXT("Translation value is not holding GfVec3d at time %d"), KeyInt);
-			}
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	const FUSDMaterialNameMap MaterialsByName(FMaterialNameConvention::LoadFromConfig(), GetAllMaterials());
+
+	const TArray<FMaterialInfo>& MaterialNames = GetStageIndex(StageActor).GetMaterialBindings();
+
+	struct FPendingMaterialAssignment
+	{
+		TWeakObjectPtr<UMeshComponent> MeshComponent;
+		FSoftObjectPath MaterialPath;
+	};
+
+	TArray<FPendingMaterialAssignment> Assignments;
+	TSet<FSoftObjectPath> MaterialsToLoad;
+	TSet<FString> UnmatchedNames;
+	for (const FMaterialInfo& Mat : MaterialNames)
+	{
+		UMeshComponent* MeshComponent = Cast<UMeshComponent>(StageActor->GetGeneratedComponent(Mat.PrimPath.GetString()));
+		if (!MeshComponent)
+		{
+			continue;
 		}
-		else
+
+		const FAssetData* FoundMaterial = MaterialsByName.Find(Mat.MatName);
+		if (!FoundMaterial)
 		{
-			UE_LOG(LogTemp, Error, TEXT("Failed to get translation value at time %d"), KeyInt);
+			UnmatchedNames.Add(Mat.MatName);
+			continue;
 		}
+
+		FPendingMaterialAssignment& Assignment = Assignments.AddDefaulted_GetRef();
+		Assignment.MeshComponent = MeshComponent;
+		Assignment.MaterialPath = FoundMaterial->GetSoftObjectPath();
+		MaterialsToLoad.Add(Assignment.MaterialPath);
+	}
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Matched %d of %d bindings to %d of %d project materials in %.2f ms"),
+		Assignments.Num(), MaterialNames.Num(), MaterialsToLoad.Num(), MaterialsByName.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+
+	if (UnmatchedNames.Num() > 0)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("%d materials not found in project: %s"), UnmatchedNames.Num(), *FString::Join(UnmatchedNames.Array(), TEXT(", ")));
 	}
 
-	for (double Time : Camera.RotTimeSamples)
+	if (Assignments.Num() == 0)
 	{
-		int KeyInt = static_cast<int>(Time);
-		FFrameNumber FrameNumber = FFrameNumber(KeyInt * TicksPerFrame);
-		if (Camera.Rotation.Get(UsdValue, Time))
+		return FReply::Handled();
+	}
+
+	// Only the matched materials get loaded, in the background, and are assigned once they are all in memory
+	const double LoadStartSeconds = FPlatformTime::Seconds();
+	MaterialLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MaterialsToLoad.Array(),
+		FStreamableDelegate::CreateLambda([Assignments = MoveTemp(Assignments), LoadStartSeconds]()
 		{
-			pxr::VtValue PxrValue = UsdValue.GetUsdValue();
-			if (PxrValue.IsHolding<pxr::GfVec3f>())
+			int32 NumAssigned = 0;
+			for (const FPendingMaterialAssignment& Assignment : Assignments)
 			{
-				pxr::GfVec3f Rotation = PxrValue.Get<pxr::GfVec3f>();
-				// RotateX->AddConstantKey(FrameNumber, Rotation[0]);
-				// RotateY->AddConstantKey(FrameNumber, (Rotation[1] * -1) - 90);
-				// RotateZ->AddConstantKey(FrameNumber, Rotation[2]);
-				RotateX->AddConstantKey(FrameNumber, Rotation[2]);
-				RotateY->AddConstantKey(FrameNumber, Rotation[0]);
-				RotateZ->AddConstantKey(FrameNumber, (Rotation[1] * -1) - 90);
-				// UE_LOG(LogTemp, Log, TEXT("Added rotation key at time %d: (%f, %f, %f)"), KeyInt, Rotation[0], (Rotation[1] * -1) - 90, Rotation[2]);
-			}
-			else
-			{
-				UE_LOG(LogTemp, Error, TEXT("Rotation value is not holding GfVec3f at time %d"), KeyInt);
+				UMeshComponent* MeshComponent = Assignment.MeshComponent.Get();
+				UMaterialInterface* Material = Cast<UMaterialInterface>(Assignment.MaterialPath.ResolveObject());
+				if (MeshComponent && Material)
+				{
+					MeshComponent->SetMaterial(0, Material);
+					++NumAssigned;
+					UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Assigned material: %s to component: %s"), *Material->GetName(), *MeshComponent->GetName());
+				}
 			}
+
+			UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Assigned %d materials, %.2f ms after the load request"), NumAssigned, (FPlatformTime::Seconds() - LoadStartSeconds) * 1000.0);
+		}));
+
+	return FReply::Handled();
+}
+
+TArray<FAssetData> FUSDCameraFrameRangesModule::GetAllMaterials()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraFrameRangesModule::GetAllMaterials);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, AssetLookup);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// UMaterial and every material instance class derive from UMaterialInterface. Only the registry is queried, nothing gets loaded
+	FARFilter Filter;
+	Filter.PackagePaths.Add(TEXT("/Game/Materials"));
+	Filter.bRecursivePaths = true;
+	Filter.ClassPaths.Add(UMaterialInterface::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+
+	TArray<FAssetData> Materials;
+	AssetRegistry.GetAssets(Filter, Materials);
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Found %d material assets in /Game/Materials"), Materials.Num());
+
+	return Materials;
+}
+
+
+FGuid FUSDCameraFrameRangesModule::AddCameraToLevelSequence(ULevelSequence* LevelSequence, TObjectPtr<ACineCameraActor> CameraActor,
+	FCameraBakeData& BakeData, const FCameraKeyReductionSettings& Reduction)
+{
+	FGuid Guid = Cast<UMovieSceneSequence>(LevelSequence)->CreatePossessable(CameraActor);
+
+	if (Guid.IsValid())
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Camera actor added to %s with Guid %s"), *LevelSequence->GetPathName(), *Guid.ToString());
+	}
+	else
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Guid invalid"));
+		return Guid;
+	}
+
+	USDCameraBaker::ApplyBakeData(*LevelSequence->MovieScene, Guid, BakeData, Reduction);
+
+	// Lens tracks live on the camera component, which gets its own binding parented to the actor's
+	UCineCameraComponent* CameraComponent = CameraActor->GetCineCameraComponent();
+	if (CameraComponent && USDCameraBaker::HasLensAnimation(BakeData))
+	{
+		const FGuid ComponentGuid = LevelSequence->FindOrAddBinding(CameraComponent);
+		if (ComponentGuid.IsValid())
+		{
+			USDCameraBaker::ApplyLensBakeData(*LevelSequence->MovieScene, ComponentGuid, BakeData);
 		}
 		else
 		{
-			UE_LOG(LogTemp, Error, TEXT("Failed to get rotation value at time %d"), KeyInt);
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to bind the camera component of %s, its lens animation is not baked"), *BakeData.CameraName);
 		}
 	}
 
-	TransformTrack->AddSection(*TransformSection);
+	if (Reduction.bEnabled)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Reduced the keys of %s from %d to %d"), *BakeData.CameraName, BakeData.NumKeysBaked, BakeData.NumKeysKept);
+	}
 
+	return Guid;
 }
 
 
@@ -544,212 +986,103 @@ void FUSDCameraFrameRangesModule::RegisterMenus()
 	}
 }
 
-TObjectPtr<AUsdStageActor> FUSDCameraFrameRangesModule::GetUsdStageActor()
+TArray<TObjectPtr<AUsdStageActor>> FUSDCameraFrameRangesModule::GetUsdStageActors()
 {
+	TArray<TObjectPtr<AUsdStageActor>> StageActors;
+
 	if (!GEditor)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("GEditor is not available"));
-		return nullptr;
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("GEditor is not available"));
+		return StageActors;
 	}
     
 	UWorld* World = GEditor->GetEditorWorldContext().World();
 
-	TArray<AActor*> StageActors;
-	UGameplayStatics::GetAllActorsOfClass(World, AUsdStageActor::StaticClass(), StageActors);
+	TArray<AActor*> Actors;
+	UGameplayStatics::GetAllActorsOfClass(World, AUsdStageActor::StaticClass(), Actors);
+
+	for (AActor* Actor : Actors)
+	{
+		if (AUsdStageActor* StageActor = Cast<AUsdStageActor>(Actor))
+		{
+			StageActors.Add(StageActor);
+		}
+	}
 
 	if (StageActors.Num() == 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("No AUsdStageActor found in the world"));
-		return nullptr;
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("No AUsdStageActor found in the world"));
+		return StageActors;
 	}
-	else if (StageActors.Num() > 1)
+
+	// Keeps the stage sections of the tab in a stable order
+	StageActors.Sort([](const TObjectPtr<AUsdStageActor>& A, const TObjectPtr<AUsdStageActor>& B)
+	{
+		return A->GetActorLabel() < B->GetActorLabel();
+	});
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Found %d USDStageActors"), StageActors.Num());
+	return StageActors;
+}
+
+ULevelSequence* FUSDCameraFrameRangesModule::FindOrCreateSequence(const FString& PackageName, bool& bOutCreated)
+{
+	bOutCreated = false;
+
+	if (const TWeakObjectPtr<ULevelSequence>* CachedSequence = SequenceCache.Find(PackageName))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Multiple UsdStageActor's detected, using first one found"));
-		return nullptr;
+		if (ULevelSequence* Sequence = CachedSequence->Get())
+		{
+			return Sequence;
+		}
 	}
-		
 
-	// Will only work with one UsdStageActor, which is the aim for this project
-	TObjectPtr<AUsdStageActor> StageActor = Cast<AUsdStageActor>(StageActors[0]);
-	if (!StageActor)
+	ULevelSequence* Sequence = USDCameraSequenceUtils::FindOrCreateLevelSequence(PackageName, bOutCreated);
+	if (Sequence)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("USDStageActor pointer is null"));
-		return nullptr;
+		SequenceCache.Add(PackageName, Sequence);
 	}
-    
-	UE_LOG(LogTemp, Log, TEXT("USDStageActor assigned"));
-	return StageActor;
+	return Sequence;
 }
 
 
-// TODO add protection against array length stuff
-TArray<FCameraInfo> FUSDCameraFrameRangesModule::GetCamerasFromUSDStage(TObjectPtr<AUsdStageActor> StageActor)
+TSharedRef<const FUSDCameraStore> FUSDCameraFrameRangesModule::GetCamerasFromUSDStage(TObjectPtr<AUsdStageActor> StageActor)
 {
-    TArray<FCameraInfo> Cameras;
-
     if (!StageActor)
     {
-        UE_LOG(LogTemp, Warning, TEXT("StageActor is null."));
-        return Cameras;
+        UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("StageActor is null."));
+        return MakeShared<const FUSDCameraStore>();
     }
 
-    UE::FUsdStage StageBase = StageActor->GetUsdStage();
-    UE::FUsdPrim root = StageBase.GetPseudoRoot();
+    TSharedRef<const FUSDCameraStore> Cameras = GetStageIndex(StageActor).GetCameras();
 
-    TArray<UE::FSdfPath> CameraPaths;
-    TraverseAndCollectCameras(root, CameraPaths);
-
-    if (CameraPaths.Num() == 0)
+    if (Cameras->Num() == 0)
     {
-        UE_LOG(LogTemp, Warning, TEXT("No cameras found in the USD Stage."));
-        return Cameras;
-    }
-
-    for (UE::FSdfPath path : CameraPaths)
-    {
-        UE::FUsdPrim CurrentPrim = StageBase.GetPrimAtPath(path);
-        if (!CurrentPrim)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Failed to get Prim at path: %s"), *path.GetString());
-            continue;
-        }
-
-        FCameraInfo CameraInfo;
-        CameraInfo.CameraName = CurrentPrim.GetName().ToString();
-        
-        CameraInfo.Translation = CurrentPrim.GetAttribute(TEXT("xformOp:translate"));
-        CameraInfo.Rotation = CurrentPrim.GetAttribute(TEXT("xformOp:rotateXYZ"));
-
-        if (CameraInfo.Rotation && CameraInfo.Translation)
-        {
-            CameraInfo.Rotation.GetTimeSamples(CameraInfo.RotTimeSamples);
-            CameraInfo.Translation.GetTimeSamples(CameraInfo.TransTimeSamples);
-            
-            if (CameraInfo.RotTimeSamples.Num() > 1 || CameraInfo.TransTimeSamples.Num() > 1)
-            {
-                if (CameraInfo.RotTimeSamples.Num() > CameraInfo.TransTimeSamples.Num())
-                {
-                    if (CameraInfo.RotTimeSamples[1] == 2.0)
-                        CameraInfo.StartFrame = CameraInfo.RotTimeSamples[0];
-                    else
-                        CameraInfo.StartFrame = CameraInfo.RotTimeSamples[1];
-
-                    CameraInfo.EndFrame = CameraInfo.RotTimeSamples.Last();
-                }
-                else
-                {
-                    if (CameraInfo.RotTimeSamples[1] == 2.0)
-                        CameraInfo.StartFrame = CameraInfo.RotTimeSamples[0];
-                    else
-                        CameraInfo.StartFrame = CameraInfo.RotTimeSamples[1];
-
-                    CameraInfo.EndFrame = CameraInfo.TransTimeSamples.Last();
-                }
-            }
-            else
-            {
-                CameraInfo.StartFrame = 1;
-                CameraInfo.EndFrame = 1;
-            }
-
-            Cameras.Add(CameraInfo);
-        }
-        else
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Failed to get necessary attributes for camera: %s"), *CameraInfo.CameraName);
-        }
+        UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("No cameras found in the USD Stage."));
     }
 
     return Cameras;
 }
 
 
-void FUSDCameraFrameRangesModule::TraverseAndCollectCameras(UE::FUsdPrim& CurrentPrim,
-	TArray<UE::FSdfPath>& OutCameraPaths)
+FUSDStageIndex& FUSDCameraFrameRangesModule::GetStageIndex(TObjectPtr<AUsdStageActor> StageActor)
 {
-
-	if (CurrentPrim.IsA(FName(TEXT("Camera"))))
-	{
-		UE::FSdfPath path = CurrentPrim.GetPrimPath();
-		OutCameraPaths.Add(path);
-        UE_LOG(LogTemp, Log, TEXT("Camera found at path: %s"), *path.GetString());
-	}
-
-	for (UE::FUsdPrim& Child : CurrentPrim.GetChildren())
+	// Indices of deleted actors are dropped, the others stay cached for as long as their actor lives
+	for (auto It = StageIndices.CreateIterator(); It; ++It)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Traversing from %s, type: %s"), *Child.GetName().ToString(), *Child.GetTypeName().ToString());
-		TraverseAndCollectCameras(Child, OutCameraPaths);
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
 	}
-}
 
-
-void FUSDCameraFrameRangesModule::TraverseAndCollectMaterials(TObjectPtr<AUsdStageActor> StageActor, UE::FUsdPrim& CurrentPrim, TArray<FMaterialInfo>& MaterialNames)
-{
-	UE::FUsdStage Stage = StageActor->GetUsdStage();
-	if (!CurrentPrim)
+	TSharedPtr<FUSDStageIndex>& Index = StageIndices.FindOrAdd(StageActor);
+	if (!Index.IsValid())
 	{
-		return;
+		Index = MakeShared<FUSDStageIndex>(StageActor);
 	}
 
-	
-	const TCHAR* RelationshipName = TEXT("material:binding");
-	if (UE::FUsdRelationship MaterialBindingRel = CurrentPrim.GetRelationship(RelationshipName))
-	{
-		TArray<UE::FSdfPath> TargetPaths;
-		bool bTargets = MaterialBindingRel.GetTargets(TargetPaths);
-		if (bTargets)
-		{
-			for (const UE::FSdfPath& Path : TargetPaths)
-			{
-				UE_LOG(LogTemp, Log, TEXT("Current prim: %s Target path: %s"), *CurrentPrim.GetName().ToString(), *Path.GetString());
-
-				if (UE::FUsdPrim MaterialPrim = Stage.GetPrimAtPath(Path))
-				{
-					FString MaterialName = MaterialPrim.GetName().ToString();
-					UE_LOG(LogTemp, Log, TEXT("Material found: %s"), *MaterialName);
-
-					for (UE::FUsdPrim ChildPrim : MaterialPrim.GetChildren())
-					{
-						if (ChildPrim.IsA("Shader"))
-						{
-							FString ShaderName = ChildPrim.GetName().ToString();
-							UE_LOG(LogTemp, Log, TEXT("Shader found: %s"), *ShaderName);
-
-							FMaterialInfo MaterialInfo;
-							MaterialInfo.ObjName = CurrentPrim.GetName().ToString();
-							MaterialInfo.MatName = ShaderName;
-							MaterialInfo.PrimPath = CurrentPrim.GetPrimPath();
-
-							UE_LOG(LogTemp, Log, TEXT("Adding material info, ObjName: %s MatName: %s PrimPath: %s"), *MaterialInfo.ObjName,  *MaterialInfo.MatName, *MaterialInfo.PrimPath.GetString());
-
-							
-							MaterialNames.Add(MaterialInfo);
-						}
-					}
-				}
-			}
-		}
-	}
-	// if (pxr::UsdShadeMaterial Material = pxr::UsdShadeMaterial::Get(Stage, CurrentPrim.GetPrimPath()))
-	// {
-	// 	// Collect the material information
-	// 	FMaterialInfo MaterialInfo;
-	// 	pxr::UsdPrim MatPrim = Material.GetPrim();
-	// 	MaterialInfo.ObjName = CurrentPrim.GetName().ToString();
-	// 	MaterialInfo.MatName = FString(MatPrim.GetPrimPath().GetName().c_str());
-	// 	MaterialInfo.PrimPath = CurrentPrim.GetPrimPath();
-	//
-	// 	UE_LOG(LogTemp, Log, TEXT("Material found, object name: %s material name: %s prim path: %s"), *MaterialInfo.ObjName, *MaterialInfo.MatName, *MaterialInfo.PrimPath.GetString() );
-	//
-	// 	MaterialNames.Add(MaterialInfo);
-	//
-	// }
-
-	for (pxr::UsdPrim ChildPrim : CurrentPrim.GetChildren())
-	{
-		UE::FUsdPrim UEChildPrim(ChildPrim);
-		TraverseAndCollectMaterials(StageActor, UEChildPrim, MaterialNames);
-	}
+	return *Index;
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraFrameRangesAPI.h"
+
+#include "USDCameraBaker.h"
+#include "USDCameraFrameRangesLog.h"
+#include "USDCameraSequenceUtils.h"
+#include "USDCameraStore.h"
+#include "USDStageIndex.h"
+#include "USDTimeMapping.h"
+#include "LevelSequence.h"
+#include "MovieScene.h"
+#include "UnrealUSDWrapper.h"
+
+namespace USDCameraFrameRanges
+{
+	UE::FUsdStage OpenStage(const FString& FilePath, bool bLoadPayloads)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraFrameRanges::OpenStage);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, OpenStage);
+
+		// Not going through the stage cache keeps stages opened from different threads private to each caller
+		UE::FUsdStage Stage = UnrealUSDWrapper::OpenStage(*FilePath, bLoadPayloads ? EUsdInitialLoadSet::LoadAll : EUsdInitialLoadSet::LoadNone, false);
+		if (!Stage)
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Failed to open the USD stage %s"), *FilePath);
+		}
+		return Stage;
+	}
+
+	TArray<FCameraInfo> GetCameras(const UE::FUsdStage& Stage)
+	{
+		return FUSDStageIndex::CollectCameras(Stage).ToCameraInfos();
+	}
+
+	TArray<FMaterialInfo> GetMaterialBindings(const UE::FUsdStage& Stage)
+	{
+		return FUSDStageIndex::CollectMaterialBindings(Stage);
+	}
+
+	int32 BakeCameras(const UE::FUsdStage& Stage, const TArray<FCameraInfo>& Cameras, ULevelSequence& LevelSequence)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraFrameRanges::BakeCameras);
+
+		check(IsInGameThread());
+
+		if (!Stage)
+		{
+			return 0;
+		}
+
+		const FUSDTimeMapping TimeMapping = FUSDTimeMapping::FromStage(Stage, LevelSequence.GetMovieScene()->GetTickResolution());
+
+		const FUSDCameraStore CameraStore(Cameras);
+		TArray<FCameraBakeData> BakeData = USDCameraBaker::BuildAllBakeData(Stage, CameraStore, CameraStore.GetAllRecords(), TimeMapping);
+
+		USDCameraSequenceUtils::AddSpawnableCameras(LevelSequence, BakeData, FCameraKeyReductionSettings::LoadFromConfig());
+		return BakeData.Num();
+	}
+}
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/**
+ * Per prim and per camera messages are Verbose, raise the verbosity to see them:
+ *   -LogCmds="LogUSDCameraFrameRanges Verbose"
+ */
+DECLARE_LOG_CATEGORY_EXTERN(LogUSDCameraFrameRanges, Log, All);
+
+/** Timings and counters of the scan, bake, material and save paths, recorded with -csvCaptureFrames or csvprofile start */
+CSV_DECLARE_CATEGORY_EXTERN(USDCameraFrameRanges);
+
+/** Adds Value to the Insights counter and to the CSV stat of the same name */
+#define USD_CAMERA_FRAME_RANGES_COUNTER_ADD(CounterName, Value) \
+	do \
+	{ \
+		TRACE_COUNTER_ADD(USDCameraFrameRanges_##CounterName, Value); \
+		CSV_CUSTOM_STAT(USDCameraFrameRanges, CounterName, static_cast<int32>(Value), ECsvCustomStatOp::Accumulate); \
+	} while (0)
@@ -0,0 +1,308 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraLivePreview.h"
+
+#include "USDCameraFrameRangesLog.h"
+#include "USDCameraSampleReader.h"
+#include "USDCameraTransformEvaluator.h"
+#include "USDStageIndex.h"
+#include "Algo/BinarySearch.h"
+#include "CineCameraActor.h"
+#include "CineCameraComponent.h"
+#include "Editor.h"
+#include "LevelEditorViewport.h"
+#include "USDMemory.h"
+#include "USDStageActor.h"
+#include "UsdWrappers/UsdAttribute.h"
+#include "UsdWrappers/UsdPrim.h"
+#include "UsdWrappers/UsdStage.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/usd/sdf/path.h"
+#include "USDIncludesEnd.h"
+
+namespace USDCameraLivePreview
+{
+	namespace Private
+	{
+		/**
+		 * Index of the last sample at or before Time, clamped to the first one. Playback moves forward by about a sample
+		 * per update, so the samples at and after Cursor are tried before searching all of them.
+		 */
+		int32 FindSample(const TArray<double>& Times, double Time, int32& Cursor)
+		{
+			if (Times.IsValidIndex(Cursor) && Times[Cursor] <= Time)
+			{
+				if (Cursor + 1 == Times.Num() || Time < Times[Cursor + 1])
+				{
+					return Cursor;
+				}
+				if (Cursor + 2 == Times.Num() || Time < Times[Cursor + 2])
+				{
+					return ++Cursor;
+				}
+			}
+
+			Cursor = FMath::Max(Algo::UpperBound(Times, Time) - 1, 0);
+			return Cursor;
+		}
+
+		/** Blend factor from the sample at Index to the next one, 0 past either end */
+		double GetAlpha(const TArray<double>& Times, int32 Index, double Time)
+		{
+			if (Index + 1 >= Times.Num() || Time <= Times[Index])
+			{
+				return 0.0;
+			}
+			return (Time - Times[Index]) / (Times[Index + 1] - Times[Index]);
+		}
+	}
+}
+
+FUSDCameraLivePreview::FUSDCameraLivePreview(AUsdStageActor& InStageActor, TSharedRef<const FUSDCameraStore> InCameras, const FUSDCameraRecord& InCamera,
+	TSharedPtr<FUSDStageIndex> InStageIndex)
+	: StageActor(&InStageActor)
+	, StageIndex(InStageIndex)
+	, Cameras(InCameras)
+	, Camera(&InCamera)
+	, CameraName(InCameras->GetName(InCamera))
+	, CameraPath(InCameras->GetPrimPath(InCamera))
+{
+	UWorld* World = InStageActor.GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	// Transient so the preview never gets saved with the level or recorded in a transaction
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags = RF_Transient;
+	ACineCameraActor* NewCameraActor = World->SpawnActor<ACineCameraActor>(SpawnParameters);
+	if (!NewCameraActor)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to spawn the preview camera of %s"), *CameraName);
+		return;
+	}
+	NewCameraActor->SetActorLabel(CameraName + TEXT("_preview"));
+	CameraActor = NewCameraActor;
+
+	DecodeSamples();
+	Update(InStageActor.GetTime());
+
+	InStageActor.OnTimeChanged.AddRaw(this, &FUSDCameraLivePreview::OnTimeChanged);
+	InStageActor.OnStageChanged.AddRaw(this, &FUSDCameraLivePreview::OnStageChanged);
+	if (InStageIndex)
+	{
+		InStageIndex->OnCamerasChanged.AddRaw(this, &FUSDCameraLivePreview::OnCamerasChanged);
+	}
+
+	if (GCurrentLevelEditingViewportClient)
+	{
+		GCurrentLevelEditingViewportClient->SetActorLock(NewCameraActor);
+	}
+}
+
+FUSDCameraLivePreview::~FUSDCameraLivePreview()
+{
+	Stop();
+}
+
+bool FUSDCameraLivePreview::IsActive() const
+{
+	return StageActor.IsValid() && CameraActor.IsValid();
+}
+
+bool FUSDCameraLivePreview::IsPreviewing(const AUsdStageActor& InStageActor, const UE::FSdfPath& InCameraPath) const
+{
+	return StageActor.Get() == &InStageActor && CameraPath == InCameraPath;
+}
+
+void FUSDCameraLivePreview::Stop()
+{
+	if (AUsdStageActor* Actor = StageActor.Get())
+	{
+		Actor->OnTimeChanged.RemoveAll(this);
+		Actor->OnStageChanged.RemoveAll(this);
+	}
+	StageActor.Reset();
+
+	if (TSharedPtr<FUSDStageIndex> Index = StageIndex.Pin())
+	{
+		Index->OnCamerasChanged.RemoveAll(this);
+	}
+
+	if (ACineCameraActor* Actor = CameraActor.Get())
+	{
+		if (GEditor)
+		{
+			for (FLevelEditorViewportClient* ViewportClient : GEditor->GetLevelViewportClients())
+			{
+				if (ViewportClient && ViewportClient->IsActorLocked(Actor))
+				{
+					ViewportClient->SetActorLock(nullptr);
+				}
+			}
+		}
+
+		if (UWorld* World = Actor->GetWorld())
+		{
+			World->DestroyActor(Actor);
+		}
+	}
+	CameraActor.Reset();
+}
+
+void FUSDCameraLivePreview::DecodeSamples()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraLivePreview::DecodeSamples);
+
+	AUsdStageActor* Actor = StageActor.Get();
+	if (!Actor)
+	{
+		return;
+	}
+
+	const UE::FUsdStage Stage = Actor->GetUsdStage();
+	FUSDCameraTransformEvaluator Evaluator(Stage);
+	if (!Evaluator.AddCamera(CameraPath))
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Camera %s is no longer on the stage"), *CameraName);
+		return;
+	}
+
+	// A camera without samples holds its transform at time 0, the same as a duplicate does
+	const TArrayView<const double> TimeSamples = Cameras->GetTimeSamples(*Camera);
+	Times.Reset(FMath::Max(TimeSamples.Num(), 1));
+	Times.Append(TimeSamples.GetData(), TimeSamples.Num());
+	if (Times.Num() == 0)
+	{
+		Times.Add(0.0);
+	}
+
+	Locations.Reset(Times.Num());
+	Rotations.Reset(Times.Num());
+	FTransform Transform;
+	for (double Time : Times)
+	{
+		if (!Evaluator.ComputeCameraTransform(CameraPath, Time, Transform))
+		{
+			Transform = FTransform::Identity;
+		}
+		Locations.Add(Transform.GetLocation());
+		Rotations.Add(Transform.GetRotation());
+	}
+
+	// Same units as the baked focal length, see FCameraLensBakeData
+	FocalLengthTimes.Reset();
+	FocalLengths.Reset();
+	const UE::FUsdAttribute FocalLengthAttribute = Stage.GetPrimAtPath(CameraPath).GetAttribute(TEXT("focalLength"));
+	const double DistanceScale = Evaluator.GetStageInfo().MetersPerUnit * 100.0;
+
+	FUsdScalarSamples Samples;
+	double FocalLength = 0.0;
+	if (USDCameraSampleReader::ReadScalarSamples(FocalLengthAttribute, Samples) && Samples.Num() > 1)
+	{
+		FocalLengthTimes = MoveTemp(Samples.Times);
+		FocalLengths.Reserve(Samples.Num());
+		for (double Value : Samples.Values)
+		{
+			FocalLengths.Add(static_cast<float>(Value * DistanceScale));
+		}
+	}
+	else if (USDCameraSampleReader::ReadScalarValue(FocalLengthAttribute, 0.0, FocalLength) && FocalLength > 0.0)
+	{
+		if (ACineCameraActor* PreviewActor = CameraActor.Get())
+		{
+			PreviewActor->GetCineCameraComponent()->SetCurrentFocalLength(static_cast<float>(FocalLength * DistanceScale));
+		}
+	}
+
+	TransformCursor = 0;
+	FocalLengthCursor = 0;
+}
+
+void FUSDCameraLivePreview::Update(double Time)
+{
+	using namespace USDCameraLivePreview::Private;
+
+	ACineCameraActor* PreviewActor = CameraActor.Get();
+	if (!PreviewActor || Times.Num() == 0 || Locations.Num() != Times.Num())
+	{
+		return;
+	}
+
+	const int32 Index = FindSample(Times, Time, TransformCursor);
+	const double Alpha = GetAlpha(Times, Index, Time);
+	if (Alpha > 0.0)
+	{
+		PreviewActor->SetActorLocationAndRotation(
+			FMath::Lerp(Locations[Index], Locations[Index + 1], Alpha),
+			FQuat::Slerp(Rotations[Index], Rotations[Index + 1], Alpha));
+	}
+	else
+	{
+		PreviewActor->SetActorLocationAndRotation(Locations[Index], Rotations[Index]);
+	}
+
+	if (FocalLengthTimes.Num() > 0)
+	{
+		const int32 FocalLengthIndex = FindSample(FocalLengthTimes, Time, FocalLengthCursor);
+		const double FocalLengthAlpha = GetAlpha(FocalLengthTimes, FocalLengthIndex, Time);
+		const float FocalLength = FocalLengthAlpha > 0.0
+			? FMath::Lerp(FocalLengths[FocalLengthIndex], FocalLengths[FocalLengthIndex + 1], static_cast<float>(FocalLengthAlpha))
+			: FocalLengths[FocalLengthIndex];
+		PreviewActor->GetCineCameraComponent()->SetCurrentFocalLength(FocalLength);
+	}
+}
+
+void FUSDCameraLivePreview::OnTimeChanged()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraLivePreview::OnTimeChanged);
+
+	if (AUsdStageActor* Actor = StageActor.Get())
+	{
+		Update(Actor->GetTime());
+	}
+}
+
+void FUSDCameraLivePreview::OnCamerasChanged(const UE::FSdfPath& RootPath)
+{
+	AUsdStageActor* Actor = StageActor.Get();
+	TSharedPtr<FUSDStageIndex> Index = StageIndex.Pin();
+	if (!Actor || !Index)
+	{
+		return;
+	}
+
+	// The index rebuilds every camera below a changed prim, since they inherit its transform
+	{
+		FScopedUsdAllocs UsdAllocs;
+		const pxr::SdfPath& UsdRootPath = RootPath;
+		const pxr::SdfPath& UsdCameraPath = CameraPath;
+		if (!UsdCameraPath.HasPrefix(UsdRootPath))
+		{
+			return;
+		}
+	}
+
+	TSharedRef<const FUSDCameraStore> UpdatedCameras = Index->GetCameras();
+	const FUSDCameraRecord* UpdatedCamera = UpdatedCameras->FindRecord(CameraPath);
+	if (!UpdatedCamera)
+	{
+		UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Stopped previewing %s, the camera is no longer on the stage"), *CameraName);
+		Stop();
+		return;
+	}
+
+	Cameras = UpdatedCameras;
+	Camera = UpdatedCamera;
+
+	DecodeSamples();
+	Update(Actor->GetTime());
+}
+
+void FUSDCameraLivePreview::OnStageChanged()
+{
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Stopped previewing %s, the stage actor loaded another stage"), *CameraName);
+	Stop();
+}
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraStore.h"
+
+class ACineCameraActor;
+class AUsdStageActor;
+class FUSDStageIndex;
+
+/**
+ * Drives a transient CineCameraActor from a camera of a stage actor whenever the actor's time changes, without baking
+ * anything, and locks the active level viewport to it.
+ * The world transform and focal length are decoded once at every sample of the camera into flat arrays, so an update
+ * is a lookup next to the previous one and an interpolation, without touching USD or allocating. Edits to the camera
+ * or its ancestors decode the samples again, once the stage index has rebuilt the camera's timeline.
+ */
+class FUSDCameraLivePreview
+{
+public:
+	/** @param InStageIndex Index of the stage actor, which tells when the camera was edited and holds its new timeline */
+	FUSDCameraLivePreview(AUsdStageActor& InStageActor, TSharedRef<const FUSDCameraStore> InCameras, const FUSDCameraRecord& InCamera,
+		TSharedPtr<FUSDStageIndex> InStageIndex);
+	~FUSDCameraLivePreview();
+
+	FUSDCameraLivePreview(const FUSDCameraLivePreview&) = delete;
+	FUSDCameraLivePreview& operator=(const FUSDCameraLivePreview&) = delete;
+
+	/** Whether the preview is still running, it stops on its own when the stage actor loads another stage */
+	bool IsActive() const;
+
+	bool IsPreviewing(const AUsdStageActor& InStageActor, const UE::FSdfPath& CameraPath) const;
+
+	/** Destroys the preview actor and releases the viewport */
+	void Stop();
+
+private:
+	/** Evaluates the camera at every time sample, the only place reading USD */
+	void DecodeSamples();
+
+	/** Moves the preview actor to the camera at Time. Doesn't allocate */
+	void Update(double Time);
+
+	void OnTimeChanged();
+	void OnCamerasChanged(const UE::FSdfPath& RootPath);
+	void OnStageChanged();
+
+	TWeakObjectPtr<AUsdStageActor> StageActor;
+	TWeakObjectPtr<ACineCameraActor> CameraActor;
+	TWeakPtr<FUSDStageIndex> StageIndex;
+
+	/** The record stays valid for as long as the store it is in is referenced */
+	TSharedRef<const FUSDCameraStore> Cameras;
+	const FUSDCameraRecord* Camera;
+	FString CameraName;
+
+	/** Made once from the record's path string, which the store keeps as the only copy of the path */
+	UE::FSdfPath CameraPath;
+
+	/** Transform samples as parallel arrays sorted by time code, rotations as quaternions to interpolate on the shortest path */
+	TArray<double> Times;
+	TArray<FVector> Locations;
+	TArray<FQuat> Rotations;
+
+	/** Empty when the focal length isn't animated */
+	TArray<double> FocalLengthTimes;
+	TArray<float> FocalLengths;
+
+	/** Samples found by the previous update, where playing forward finds the next ones */
+	int32 TransformCursor = 0;
+	int32 FocalLengthCursor = 0;
+};
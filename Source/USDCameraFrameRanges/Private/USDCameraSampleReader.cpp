@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraSampleReader.h"
+
+#include "USDMemory.h"
+#include "UsdWrappers/UsdAttribute.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/attribute.h"
+#include "pxr/usd/usd/attributeQuery.h"
+#include "pxr/usd/sdf/types.h"
+#include "USDIncludesEnd.h"
+
+namespace USDCameraSampleReader
+{
+	namespace Private
+	{
+		// Writes into the pre-sized arrays so no Unreal allocations happen while the USD allocator is active
+		template<typename ValueType>
+		int32 ReadTypedSamples(const pxr::UsdAttributeQuery& Query, const std::vector<double>& Times, FUsdScalarSamples& OutSamples)
+		{
+			ValueType Value;
+			int32 NumRead = 0;
+			for (double Time : Times)
+			{
+				if (Query.Get(&Value, pxr::UsdTimeCode(Time)))
+				{
+					OutSamples.Times[NumRead] = Time;
+					OutSamples.Values[NumRead] = Value;
+					++NumRead;
+				}
+			}
+			return NumRead;
+		}
+	}
+
+	bool ReadScalarSamples(const UE::FUsdAttribute& Attribute, FUsdScalarSamples& OutSamples)
+	{
+		OutSamples.SetNum(0);
+
+		if (!Attribute)
+		{
+			return false;
+		}
+
+		FScopedUsdAllocs UsdAllocs;
+
+		const pxr::UsdAttribute& UsdAttribute = Attribute;
+		const pxr::SdfValueTypeName TypeName = UsdAttribute.GetTypeName();
+		const bool bIsDouble = TypeName == pxr::SdfValueTypeNames->Double;
+		if (!bIsDouble && TypeName != pxr::SdfValueTypeNames->Float)
+		{
+			return false;
+		}
+
+		// The query caches value resolution, so every following Get skips the layer stack walk
+		pxr::UsdAttributeQuery Query(UsdAttribute);
+
+		std::vector<double> Times;
+		if (!Query.GetTimeSamples(&Times))
+		{
+			return false;
+		}
+
+		{
+			FScopedUnrealAllocs UnrealAllocs;
+			OutSamples.SetNumUninitialized(static_cast<int32>(Times.size()));
+		}
+
+		const int32 NumRead = bIsDouble
+			? Private::ReadTypedSamples<double>(Query, Times, OutSamples)
+			: Private::ReadTypedSamples<float>(Query, Times, OutSamples);
+
+		{
+			FScopedUnrealAllocs UnrealAllocs;
+			OutSamples.SetNum(NumRead);
+		}
+
+		return true;
+	}
+
+	bool ReadScalarValue(const UE::FUsdAttribute& Attribute, double Time, double& OutValue)
+	{
+		if (!Attribute)
+		{
+			return false;
+		}
+
+		FScopedUsdAllocs UsdAllocs;
+
+		const pxr::UsdAttribute& UsdAttribute = Attribute;
+		const pxr::SdfValueTypeName TypeName = UsdAttribute.GetTypeName();
+		if (TypeName == pxr::SdfValueTypeNames->Double)
+		{
+			double Value;
+			if (UsdAttribute.Get(&Value, pxr::UsdTimeCode(Time)))
+			{
+				OutValue = Value;
+				return true;
+			}
+		}
+		else if (TypeName == pxr::SdfValueTypeNames->Float)
+		{
+			float Value;
+			if (UsdAttribute.Get(&Value, pxr::UsdTimeCode(Time)))
+			{
+				OutValue = Value;
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE
+{
+	class FUsdAttribute;
+}
+
+/** All time samples of a scalar attribute, as two contiguous arrays */
+struct FUsdScalarSamples
+{
+	TArray<double> Times;
+	TArray<double> Values;
+
+	int32 Num() const
+	{
+		return Times.Num();
+	}
+
+	void SetNumUninitialized(int32 NewNum)
+	{
+		Times.SetNumUninitialized(NewNum);
+		Values.SetNumUninitialized(NewNum);
+	}
+
+	void SetNum(int32 NewNum)
+	{
+		Times.SetNum(NewNum);
+		Values.SetNum(NewNum);
+	}
+};
+
+namespace USDCameraSampleReader
+{
+	/**
+	 * Reads every time sample of a float or double attribute in one pass, without boxing each value in a VtValue.
+	 * An attribute that isn't animated yields no samples, read its value with ReadScalarValue instead.
+	 * @return false if the attribute is invalid or does not hold a float or double
+	 */
+	bool ReadScalarSamples(const UE::FUsdAttribute& Attribute, FUsdScalarSamples& OutSamples);
+
+	/**
+	 * Reads the value of a float or double attribute at a single time.
+	 * @return false if the attribute is invalid, has no value at that time or does not hold a float or double
+	 */
+	bool ReadScalarValue(const UE::FUsdAttribute& Attribute, double Time, double& OutValue);
+}
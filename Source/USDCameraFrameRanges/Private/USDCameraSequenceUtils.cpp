@@ -0,0 +1,304 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraSequenceUtils.h"
+
+#include "USDCameraBaker.h"
+#include "USDCameraFrameRangesLog.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "CineCameraActor.h"
+#include "CineCameraComponent.h"
+#include "FileHelpers.h"
+#include "LevelSequence.h"
+#include "MovieScene.h"
+#include "ObjectTools.h"
+#include "Sections/MovieSceneCameraCutSection.h"
+#include "Sections/MovieSceneSubSection.h"
+#include "Tracks/MovieSceneCameraCutTrack.h"
+#include "Tracks/MovieSceneCinematicShotTrack.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UsdWrappers/SdfLayer.h"
+#include "UsdWrappers/UsdStage.h"
+
+namespace USDCameraSequenceUtils
+{
+	namespace Private
+	{
+		/** Removes the spawnables a previous bake added for these cameras, along with the possessables of their components */
+		void RemovePreviousCameras(UMovieScene& MovieScene, const TArray<FCameraBakeData>& BakeData)
+		{
+			TSet<FString> CameraNames;
+			for (const FCameraBakeData& CameraBakeData : BakeData)
+			{
+				CameraNames.Add(CameraBakeData.CameraName);
+			}
+
+			TArray<FGuid> SpawnablesToRemove;
+			for (int32 Index = 0; Index < MovieScene.GetSpawnableCount(); ++Index)
+			{
+				const FMovieSceneSpawnable& Spawnable = MovieScene.GetSpawnable(Index);
+				if (CameraNames.Contains(Spawnable.GetName()))
+				{
+					SpawnablesToRemove.Add(Spawnable.GetGuid());
+				}
+			}
+
+			for (const FGuid& SpawnableGuid : SpawnablesToRemove)
+			{
+				for (int32 Index = MovieScene.GetPossessableCount() - 1; Index >= 0; --Index)
+				{
+					const FMovieScenePossessable& Possessable = MovieScene.GetPossessable(Index);
+					if (Possessable.GetParent() == SpawnableGuid)
+					{
+						MovieScene.RemovePossessable(Possessable.GetGuid());
+					}
+				}
+				MovieScene.RemoveSpawnable(SpawnableGuid);
+			}
+		}
+	}
+
+	ULevelSequence* FindOrCreateLevelSequence(const FString& PackageName, bool& bOutCreated)
+	{
+		bOutCreated = false;
+
+		if (!FPackageName::IsValidLongPackageName(PackageName))
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("%s is not a valid package name for a level sequence"), *PackageName);
+			return nullptr;
+		}
+
+		const FString AssetName = FPackageName::GetLongPackageAssetName(PackageName);
+		const FString ObjectPath = PackageName + TEXT(".") + AssetName;
+
+		if (ULevelSequence* ExistingSequence = FindObject<ULevelSequence>(nullptr, *ObjectPath))
+		{
+			return ExistingSequence;
+		}
+
+		if (FPackageName::DoesPackageExist(PackageName))
+		{
+			ULevelSequence* LoadedSequence = LoadObject<ULevelSequence>(nullptr, *ObjectPath);
+			if (!LoadedSequence)
+			{
+				UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("%s exists but does not hold a level sequence named %s"), *PackageName, *AssetName);
+			}
+			return LoadedSequence;
+		}
+
+		UPackage* Package = CreatePackage(*PackageName);
+		ULevelSequence* NewSequence = NewObject<ULevelSequence>(Package, FName(*AssetName), RF_Public | RF_Standalone | RF_Transactional);
+		NewSequence->Initialize();
+
+		FAssetRegistryModule::AssetCreated(NewSequence);
+		Package->MarkPackageDirty();
+
+		bOutCreated = true;
+		return NewSequence;
+	}
+
+	int32 AddSpawnableCameras(ULevelSequence& LevelSequence, TArray<FCameraBakeData>& BakeData, const FCameraKeyReductionSettings& Reduction)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraSequenceUtils::AddSpawnableCameras);
+
+		UMovieScene* MovieScene = LevelSequence.GetMovieScene();
+		MovieScene->Modify();
+
+		Private::RemovePreviousCameras(*MovieScene, BakeData);
+
+		int32 NumKeys = 0;
+		TOptional<TRange<FFrameNumber>> PlaybackRange;
+		for (FCameraBakeData& CameraBakeData : BakeData)
+		{
+			const FName TemplateName = MakeUniqueObjectName(MovieScene, ACineCameraActor::StaticClass(), FName(*CameraBakeData.CameraName));
+			ACineCameraActor* Template = NewObject<ACineCameraActor>(MovieScene, TemplateName, RF_Transactional);
+			UCineCameraComponent* CameraComponent = Template->GetCineCameraComponent();
+			if (CameraComponent)
+			{
+				USDCameraBaker::ApplyLensValues(*CameraComponent, CameraBakeData);
+			}
+
+			const FGuid Guid = MovieScene->AddSpawnable(CameraBakeData.CameraName, *Template);
+			USDCameraBaker::ApplyBakeData(*MovieScene, Guid, CameraBakeData, Reduction);
+			NumKeys += CameraBakeData.NumKeysKept;
+
+			// Lens tracks go on a possessable of the template's component, parented to the spawnable
+			if (CameraComponent && USDCameraBaker::HasLensAnimation(CameraBakeData))
+			{
+				const FGuid ComponentGuid = MovieScene->AddPossessable(CameraComponent->GetName(), CameraComponent->GetClass());
+				MovieScene->FindPossessable(ComponentGuid)->SetParent(Guid, MovieScene);
+				MovieScene->FindSpawnable(Guid)->AddChildPossessable(ComponentGuid);
+				LevelSequence.BindPossessableObject(ComponentGuid, *CameraComponent, Template);
+
+				USDCameraBaker::ApplyLensBakeData(*MovieScene, ComponentGuid, CameraBakeData);
+			}
+
+			PlaybackRange = PlaybackRange.IsSet() ? TRange<FFrameNumber>::Hull(PlaybackRange.GetValue(), CameraBakeData.Range) : CameraBakeData.Range;
+		}
+
+		if (PlaybackRange.IsSet())
+		{
+			MovieScene->SetPlaybackRange(PlaybackRange.GetValue());
+		}
+
+		LevelSequence.MarkPackageDirty();
+		return NumKeys;
+	}
+
+	ULevelSequence* FindOrCreateShotSequence(ULevelSequence& MasterSequence, const UE::FUsdStage& Stage, const FString& PrimPath, bool& bOutCreated)
+	{
+		bOutCreated = false;
+
+		const UE::FSdfLayer RootLayer = Stage ? Stage.GetRootLayer() : UE::FSdfLayer();
+		if (!RootLayer)
+		{
+			return nullptr;
+		}
+		const FString StageName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(RootLayer.GetIdentifier()));
+
+		// Prim names are USD identifiers, which never hold a '-', so joining them with it can't make two paths collide
+		FString ShotName = PrimPath;
+		ShotName.RemoveFromStart(TEXT("/"));
+		ShotName.ReplaceCharInline(TEXT('/'), TEXT('-'));
+
+		const FString MasterPackageName = MasterSequence.GetPackage()->GetName();
+		const FString ShotPackageName = MasterPackageName + TEXT("_Shots/") + StageName + TEXT("/") + ObjectTools::SanitizeObjectName(ShotName);
+
+		ULevelSequence* ShotSequence = FindOrCreateLevelSequence(ShotPackageName, bOutCreated);
+		if (!ShotSequence)
+		{
+			return nullptr;
+		}
+
+		const FFrameRate MasterResolution = MasterSequence.GetMovieScene()->GetTickResolution();
+		UMovieScene* ShotMovieScene = ShotSequence->GetMovieScene();
+		if (bOutCreated)
+		{
+			ShotMovieScene->SetTickResolutionDirectly(MasterResolution);
+			ShotMovieScene->SetDisplayRate(MasterSequence.GetMovieScene()->GetDisplayRate());
+		}
+		else if (ShotMovieScene->GetTickResolution() != MasterResolution)
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Error, TEXT("Shot %s does not have the tick resolution of its master %s"), *ShotPackageName, *MasterPackageName);
+			return nullptr;
+		}
+
+		return ShotSequence;
+	}
+
+	void ResetShotSequence(ULevelSequence& ShotSequence)
+	{
+		UMovieScene* MovieScene = ShotSequence.GetMovieScene();
+		MovieScene->Modify();
+
+		if (MovieScene->GetCameraCutTrack())
+		{
+			MovieScene->RemoveCameraCutTrack();
+		}
+
+		for (int32 Index = MovieScene->GetPossessableCount() - 1; Index >= 0; --Index)
+		{
+			const FGuid Guid = MovieScene->GetPossessable(Index).GetGuid();
+			ShotSequence.UnbindPossessableObjects(Guid);
+			MovieScene->RemovePossessable(Guid);
+		}
+		for (int32 Index = MovieScene->GetSpawnableCount() - 1; Index >= 0; --Index)
+		{
+			MovieScene->RemoveSpawnable(MovieScene->GetSpawnable(Index).GetGuid());
+		}
+	}
+
+	void SetShotCamera(ULevelSequence& ShotSequence, const FGuid& CameraBinding, const TRange<FFrameNumber>& Range)
+	{
+		UMovieScene* MovieScene = ShotSequence.GetMovieScene();
+		MovieScene->Modify();
+
+		UMovieSceneCameraCutTrack* CameraCutTrack = Cast<UMovieSceneCameraCutTrack>(MovieScene->GetCameraCutTrack());
+		if (!CameraCutTrack)
+		{
+			CameraCutTrack = Cast<UMovieSceneCameraCutTrack>(MovieScene->AddCameraCutTrack(UMovieSceneCameraCutTrack::StaticClass()));
+		}
+
+		UMovieSceneCameraCutSection* CameraCutSection = CameraCutTrack->AddNewCameraCut(UE::MovieScene::FRelativeObjectBindingID(CameraBinding), Range.GetLowerBoundValue());
+		CameraCutSection->SetRange(Range);
+
+		MovieScene->SetPlaybackRange(Range);
+		ShotSequence.MarkPackageDirty();
+	}
+
+	void SetShotRange(ULevelSequence& ShotSequence, const TRange<FFrameNumber>& Range)
+	{
+		UMovieScene* MovieScene = ShotSequence.GetMovieScene();
+		if (MovieScene->GetPlaybackRange() == Range)
+		{
+			return;
+		}
+
+		MovieScene->Modify();
+		if (UMovieSceneTrack* CameraCutTrack = MovieScene->GetCameraCutTrack())
+		{
+			for (UMovieSceneSection* Section : CameraCutTrack->GetAllSections())
+			{
+				Section->Modify();
+				Section->SetRange(Range);
+			}
+		}
+
+		MovieScene->SetPlaybackRange(Range);
+		ShotSequence.MarkPackageDirty();
+	}
+
+	void AddShotToMaster(ULevelSequence& MasterSequence, ULevelSequence& ShotSequence, const TRange<FFrameNumber>& Range)
+	{
+		UMovieScene* MovieScene = MasterSequence.GetMovieScene();
+		MovieScene->Modify();
+
+		UMovieSceneCinematicShotTrack* ShotTrack = MovieScene->FindTrack<UMovieSceneCinematicShotTrack>();
+		if (!ShotTrack)
+		{
+			ShotTrack = MovieScene->AddTrack<UMovieSceneCinematicShotTrack>();
+		}
+		ShotTrack->Modify();
+
+		TArray<UMovieSceneSection*> PreviousSections;
+		for (UMovieSceneSection* Section : ShotTrack->GetAllSections())
+		{
+			const UMovieSceneSubSection* SubSection = Cast<UMovieSceneSubSection>(Section);
+			if (SubSection && SubSection->GetSequence() == &ShotSequence)
+			{
+				PreviousSections.Add(Section);
+			}
+		}
+		for (UMovieSceneSection* Section : PreviousSections)
+		{
+			ShotTrack->RemoveSection(*Section);
+		}
+
+		const FFrameNumber StartFrame = Range.GetLowerBoundValue();
+		ShotTrack->AddSequence(&ShotSequence, StartFrame, (Range.GetUpperBoundValue() - StartFrame).Value);
+
+		// The master plays every shot it holds
+		TRange<FFrameNumber> PlaybackRange = Range;
+		for (UMovieSceneSection* Section : ShotTrack->GetAllSections())
+		{
+			PlaybackRange = TRange<FFrameNumber>::Hull(PlaybackRange, Section->GetRange());
+		}
+		MovieScene->SetPlaybackRange(PlaybackRange);
+
+		MasterSequence.MarkPackageDirty();
+	}
+
+	bool SavePackages(const TArray<UPackage*>& Packages)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USDCameraSequenceUtils::SavePackages);
+		CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, PackageSave);
+
+		if (Packages.Num() == 0)
+		{
+			return true;
+		}
+
+		return UEditorLoadingAndSavingUtils::SavePackages(Packages, true);
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCameraBakeData;
+struct FCameraKeyReductionSettings;
+class ULevelSequence;
+class UPackage;
+
+namespace UE
+{
+	class FUsdStage;
+}
+
+namespace USDCameraSequenceUtils
+{
+	/**
+	 * Loads the level sequence at PackageName, e.g. /Game/Cinematics/Shot010, or creates it in a new package if there is
+	 * none yet. New packages are left dirty and unsaved.
+	 * @param bOutCreated Set to whether the sequence was created by this call
+	 * @return nullptr if PackageName isn't a valid long package name or holds something else
+	 */
+	ULevelSequence* FindOrCreateLevelSequence(const FString& PackageName, bool& bOutCreated);
+
+	/**
+	 * Adds one spawnable CineCameraActor per camera, so the sequence doesn't depend on any level, and sets the playback
+	 * range to cover them all. Spawnables named after these cameras are replaced. Moves the keys out of BakeData.
+	 * Game thread only
+	 * @return Number of transform keys added
+	 */
+	int32 AddSpawnableCameras(ULevelSequence& LevelSequence, TArray<FCameraBakeData>& BakeData, const FCameraKeyReductionSettings& Reduction);
+
+	/**
+	 * Loads or creates the shot sequence of a camera, in a folder named after the master with a subfolder per stage and
+	 * named after the camera's prim path, e.g. /Game/Cinematics/Seq_Shots/sh010/World-Cams-Cam01. Cameras of the same
+	 * name in different subtrees or stages each get their own shot. Stages are told apart by the file name of their root
+	 * layer, so two files of the same name in different folders share their shots.
+	 * New shots get the tick resolution of the master so keys and sections line up without conversion.
+	 * @return nullptr if the shot exists with a different tick resolution or the names don't make a valid package
+	 */
+	ULevelSequence* FindOrCreateShotSequence(ULevelSequence& MasterSequence, const UE::FUsdStage& Stage, const FString& PrimPath, bool& bOutCreated);
+
+	/**
+	 * Empties a generated shot of the bindings and camera cuts of a previous bake, so baking the same camera again doesn't
+	 * pile up duplicates
+	 */
+	void ResetShotSequence(ULevelSequence& ShotSequence);
+
+	/** Cuts to the camera binding for the whole range and makes that range the playback range of the shot */
+	void SetShotCamera(ULevelSequence& ShotSequence, const FGuid& CameraBinding, const TRange<FFrameNumber>& Range);
+
+	/** Moves the camera cuts and the playback range of a shot baked by SetShotCamera to Range, if it changed */
+	void SetShotRange(ULevelSequence& ShotSequence, const TRange<FFrameNumber>& Range);
+
+	/** Places the shot on the master's cinematic shot track over Range, replacing the sections a previous bake added for it */
+	void AddShotToMaster(ULevelSequence& MasterSequence, ULevelSequence& ShotSequence, const TRange<FFrameNumber>& Range);
+
+	/** Saves the packages in one batch, skipping those that aren't dirty. Game thread only */
+	bool SavePackages(const TArray<UPackage*>& Packages);
+}
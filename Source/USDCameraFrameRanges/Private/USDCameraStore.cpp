@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraStore.h"
+
+FUSDCameraStore::FUSDCameraStore(const TArray<FCameraInfo>& Cameras)
+{
+	int32 NumSamples = 0;
+	for (const FCameraInfo& Camera : Cameras)
+	{
+		NumSamples += Camera.TimeSamples.Num();
+	}
+
+	Reserve(Cameras.Num(), NumSamples);
+	for (const FCameraInfo& Camera : Cameras)
+	{
+		Add(Camera);
+	}
+}
+
+void FUSDCameraStore::Reserve(int32 NumCameras, int32 NumSamples)
+{
+	Records.Reserve(NumCameras);
+	RecordsByPathHash.Reserve(NumCameras);
+	TimeSamples.Reserve(NumSamples);
+}
+
+void FUSDCameraStore::Add(const FCameraInfo& Camera)
+{
+	AddRecord(Camera.CameraName, Camera.PrimPath.GetString(), Camera.TimeSamples, Camera.StartFrame, Camera.EndFrame);
+}
+
+void FUSDCameraStore::Add(const FUSDCameraStore& Other, const FUSDCameraRecord& Record)
+{
+	AddRecord(Other.GetName(Record), Other.GetPrimPathString(Record), Other.GetTimeSamples(Record), Record.StartFrame, Record.EndFrame);
+}
+
+void FUSDCameraStore::AddRecord(FStringView Name, FStringView PrimPathString, TArrayView<const double> InTimeSamples, int32 StartFrame, int32 EndFrame)
+{
+	RecordsByPathHash.Add(HashPrimPath(PrimPathString), Records.Num());
+
+	FUSDCameraRecord& Record = Records.AddDefaulted_GetRef();
+	Record.StartFrame = StartFrame;
+	Record.EndFrame = EndFrame;
+
+	Record.NameOffset = Strings.Num();
+	Record.NameLength = Name.Len();
+	Strings.Append(Name.GetData(), Name.Len());
+
+	Record.PathOffset = Strings.Num();
+	Record.PathLength = PrimPathString.Len();
+	Strings.Append(PrimPathString.GetData(), PrimPathString.Len());
+
+	Record.FirstSample = TimeSamples.Num();
+	Record.NumSamples = InTimeSamples.Num();
+	TimeSamples.Append(InTimeSamples.GetData(), InTimeSamples.Num());
+}
+
+void FUSDCameraStore::Shrink()
+{
+	Records.Shrink();
+	RecordsByPathHash.Shrink();
+	Strings.Shrink();
+	TimeSamples.Shrink();
+}
+
+TArray<const FUSDCameraRecord*> FUSDCameraStore::GetAllRecords() const
+{
+	TArray<const FUSDCameraRecord*> Result;
+	Result.Reserve(Records.Num());
+	for (const FUSDCameraRecord& Record : Records)
+	{
+		Result.Add(&Record);
+	}
+	return Result;
+}
+
+const FUSDCameraRecord* FUSDCameraStore::FindRecord(FStringView PrimPath) const
+{
+	for (auto It = RecordsByPathHash.CreateConstKeyIterator(HashPrimPath(PrimPath)); It; ++It)
+	{
+		const FUSDCameraRecord& Record = Records[It.Value()];
+		if (GetPrimPathString(Record).Equals(PrimPath, ESearchCase::CaseSensitive))
+		{
+			return &Record;
+		}
+	}
+	return nullptr;
+}
+
+FCameraInfo FUSDCameraStore::ToCameraInfo(const FUSDCameraRecord& Record) const
+{
+	FCameraInfo Camera;
+	Camera.CameraName = FString(GetName(Record));
+	Camera.PrimPath = GetPrimPath(Record);
+	Camera.TimeSamples.Append(GetTimeSamples(Record).GetData(), Record.NumSamples);
+	Camera.StartFrame = Record.StartFrame;
+	Camera.EndFrame = Record.EndFrame;
+	return Camera;
+}
+
+TArray<FCameraInfo> FUSDCameraStore::ToCameraInfos() const
+{
+	TArray<FCameraInfo> Cameras;
+	Cameras.Reserve(Records.Num());
+	for (const FUSDCameraRecord& Record : Records)
+	{
+		Cameras.Add(ToCameraInfo(Record));
+	}
+	return Cameras;
+}
+
+SIZE_T FUSDCameraStore::GetAllocatedSize() const
+{
+	return Records.GetAllocatedSize() + Strings.GetAllocatedSize() + TimeSamples.GetAllocatedSize() + RecordsByPathHash.GetAllocatedSize();
+}
@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraFrameRanges.h"
+#include "UsdWrappers/SdfPath.h"
+
+/**
+ * One camera of a FUSDCameraStore. The name, prim path and time samples are ranges of arrays shared by every camera of
+ * the store, so a record has the same small size however long the camera is, and holds no allocation of its own.
+ */
+struct FUSDCameraRecord
+{
+	int32 NameOffset = 0;
+	int32 NameLength = 0;
+	int32 PathOffset = 0;
+	int32 PathLength = 0;
+	int32 FirstSample = 0;
+	int32 NumSamples = 0;
+
+	int32 StartFrame = 0;
+	int32 EndFrame = 0;
+};
+
+/**
+ * Cameras of a stage packed into three arrays: the records, one buffer holding every name and path string, and one
+ * holding every time sample. A store is filled once and then shared read only through a TSharedRef<const
+ * FUSDCameraStore>, so the camera list and the bake refer to records by pointer instead of copying cameras. Record
+ * pointers stay valid for as long as the store lives, changes to the stage make a new store.
+ */
+class FUSDCameraStore
+{
+public:
+	FUSDCameraStore() = default;
+	explicit FUSDCameraStore(const TArray<FCameraInfo>& Cameras);
+
+	void Reserve(int32 NumCameras, int32 NumSamples);
+	void Add(const FCameraInfo& Camera);
+
+	/** Copies a record of another store, along with its strings and samples */
+	void Add(const FUSDCameraStore& Other, const FUSDCameraRecord& Record);
+
+	/** Releases the slack left by adding cameras one at a time, once they are all added */
+	void Shrink();
+
+	int32 Num() const
+	{
+		return Records.Num();
+	}
+
+	const TArray<FUSDCameraRecord>& GetRecords() const
+	{
+		return Records;
+	}
+
+	/** Pointers to every record, in the order they were added */
+	TArray<const FUSDCameraRecord*> GetAllRecords() const;
+
+	/** @return nullptr if no camera of the store is at PrimPath */
+	const FUSDCameraRecord* FindRecord(FStringView PrimPath) const;
+	const FUSDCameraRecord* FindRecord(const UE::FSdfPath& PrimPath) const
+	{
+		return FindRecord(PrimPath.GetString());
+	}
+
+	FStringView GetName(const FUSDCameraRecord& Record) const
+	{
+		return FStringView(Strings.GetData() + Record.NameOffset, Record.NameLength);
+	}
+
+	FStringView GetPrimPathString(const FUSDCameraRecord& Record) const
+	{
+		return FStringView(Strings.GetData() + Record.PathOffset, Record.PathLength);
+	}
+
+	/** Path of the camera for the USD API, made from its string on each call */
+	UE::FSdfPath GetPrimPath(const FUSDCameraRecord& Record) const
+	{
+		return UE::FSdfPath(*FString(GetPrimPathString(Record)));
+	}
+
+	/** Sorted, unique times of every xformOp sample of the camera and of the ancestors it inherits a transform from */
+	TArrayView<const double> GetTimeSamples(const FUSDCameraRecord& Record) const
+	{
+		return TArrayView<const double>(TimeSamples.GetData() + Record.FirstSample, Record.NumSamples);
+	}
+
+	/** Standalone copy of a camera, for the public API */
+	FCameraInfo ToCameraInfo(const FUSDCameraRecord& Record) const;
+	TArray<FCameraInfo> ToCameraInfos() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void AddRecord(FStringView Name, FStringView PrimPathString, TArrayView<const double> InTimeSamples, int32 StartFrame, int32 EndFrame);
+
+	static uint32 HashPrimPath(FStringView PrimPath)
+	{
+		return FCrc::MemCrc32(PrimPath.GetData(), PrimPath.Len() * sizeof(TCHAR));
+	}
+
+	TArray<FUSDCameraRecord> Records;
+	TArray<TCHAR> Strings;
+	TArray<double> TimeSamples;
+
+	/** Index of the records by the hash of their path, which stays in Strings rather than being copied as a key */
+	TMultiMap<uint32, int32> RecordsByPathHash;
+};
@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDCameraTransformEvaluator.h"
+
+#include "USDCameraFrameRangesLog.h"
+#include "USDMemory.h"
+#include "Misc/ScopeRWLock.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "USDIncludesEnd.h"
+
+FUSDCameraTransformEvaluator::FUSDCameraTransformEvaluator(const UE::FUsdStage& InStage)
+	: Stage(InStage)
+	, StageInfo(InStage)
+{
+}
+
+FUSDCameraTransformEvaluator::~FUSDCameraTransformEvaluator()
+{
+	// The xform queries own op arrays allocated by USD
+	FScopedUsdAllocs UsdAllocs;
+	Prims.Empty();
+}
+
+bool FUSDCameraTransformEvaluator::AddCamera(const UE::FSdfPath& CameraPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDCameraTransformEvaluator::AddCamera);
+
+	if (!Stage)
+	{
+		return false;
+	}
+
+	FScopedUsdAllocs UsdAllocs;
+
+	const pxr::UsdStageRefPtr& UsdStage = Stage;
+	pxr::UsdPrim Prim = UsdStage->GetPrimAtPath(CameraPath);
+	if (!Prim)
+	{
+		return false;
+	}
+
+	FindOrAddPrim(Prim);
+	return true;
+}
+
+int32 FUSDCameraTransformEvaluator::FindOrAddPrim(const pxr::UsdPrim& Prim)
+{
+	if (!Prim || Prim.IsPseudoRoot())
+	{
+		return INDEX_NONE;
+	}
+
+	const pxr::SdfPath& PrimPath = Prim.GetPrimPath();
+	{
+		FScopedUnrealAllocs UnrealAllocs;
+		if (const int32* ExistingIndex = PrimIndices.Find(UE::FSdfPath(PrimPath)))
+		{
+			return *ExistingIndex;
+		}
+	}
+
+	// Parents first, so a prim's parent index is always lower than its own
+	const int32 ParentIndex = FindOrAddPrim(Prim.GetParent());
+
+	const int32 Index = Prims.AddDefaulted();
+	FPrimXform& Xform = Prims[Index];
+	Xform.ParentIndex = ParentIndex;
+
+	pxr::UsdGeomXformable Xformable(Prim);
+	if (Xformable)
+	{
+		Xform.Query = pxr::UsdGeomXformable::XformQuery(Xformable);
+		Xform.bIsXformable = true;
+		Xform.bResetsXformStack = Xform.Query.GetResetXformStack();
+		Xform.bWorldMightBeTimeVarying = Xform.Query.TransformMightBeTimeVarying();
+	}
+
+	if (ParentIndex != INDEX_NONE)
+	{
+		FPrimXform& Parent = Prims[ParentIndex];
+		Parent.bIsCached = true;
+		if (!Xform.bResetsXformStack)
+		{
+			Xform.bWorldMightBeTimeVarying |= Parent.bWorldMightBeTimeVarying;
+		}
+	}
+
+	{
+		FScopedUnrealAllocs UnrealAllocs;
+		PrimIndices.Add(UE::FSdfPath(PrimPath), Index);
+	}
+
+	return Index;
+}
+
+bool FUSDCameraTransformEvaluator::ComputeCameraTransform(const UE::FSdfPath& CameraPath, double Time, FTransform& OutTransform) const
+{
+	const int32* PrimIndex = PrimIndices.Find(CameraPath);
+	if (!PrimIndex)
+	{
+		return false;
+	}
+
+	pxr::GfMatrix4d LocalToWorld;
+	{
+		FScopedUsdAllocs UsdAllocs;
+		LocalToWorld = ComputeLocalToWorld(*PrimIndex, Time);
+	}
+
+	// USD cameras look down -Z with +Y up, a CineCameraActor down +X with +Z up. ConvertMatrix only mirrors the axes, so
+	// a camera's local -Z and +Y come out as -Z and -Y on a Z up stage, and as -Y and +Z on a Y up stage
+	const FRotator CameraCorrection = StageInfo.UpAxis == EUsdUpAxis::YAxis ? FRotator(0.0f, -90.0f, 0.0f) : FRotator(-90.0f, -90.0f, 0.0f);
+
+	OutTransform = FTransform(CameraCorrection) * UsdToUnreal::ConvertMatrix(StageInfo, LocalToWorld);
+	return true;
+}
+
+int32 FUSDCameraTransformEvaluator::GetNumCachedMatrices() const
+{
+	FReadScopeLock Lock(MatrixCacheLock);
+	return MatrixCache.Num();
+}
+
+pxr::GfMatrix4d FUSDCameraTransformEvaluator::ComputeLocalToWorld(int32 PrimIndex, double Time) const
+{
+	const FPrimXform& Xform = Prims[PrimIndex];
+
+	// Static subtrees share a single cache entry whatever the time
+	const FMatrixCacheKey CacheKey{ PrimIndex, Xform.bWorldMightBeTimeVarying ? Time : 0.0 };
+	if (Xform.bIsCached)
+	{
+		FReadScopeLock Lock(MatrixCacheLock);
+		if (const pxr::GfMatrix4d* CachedMatrix = MatrixCache.Find(CacheKey))
+		{
+			return *CachedMatrix;
+		}
+	}
+
+	pxr::GfMatrix4d LocalToWorld(1.0);
+	if (Xform.bIsXformable)
+	{
+		Xform.Query.GetLocalTransformation(&LocalToWorld, pxr::UsdTimeCode(CacheKey.Time));
+	}
+
+	if (Xform.ParentIndex != INDEX_NONE && !Xform.bResetsXformStack)
+	{
+		// USD matrices transform row vectors, so the parent is applied last
+		LocalToWorld *= ComputeLocalToWorld(Xform.ParentIndex, Time);
+	}
+
+	if (Xform.bIsCached)
+	{
+		FScopedUnrealAllocs UnrealAllocs;
+		FWriteScopeLock Lock(MatrixCacheLock);
+		MatrixCache.Add(CacheKey, LocalToWorld);
+	}
+
+	return LocalToWorld;
+}
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDTypesConversion.h"
+#include "UsdWrappers/SdfPath.h"
+#include "UsdWrappers/UsdStage.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/pxr.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/usd/usdGeom/xformable.h"
+#include "USDIncludesEnd.h"
+
+/**
+ * Evaluates the local to world transform of cameras from the full xformOp stack of the camera and of every ancestor,
+ * whatever the op order and including xformOp:transform matrices and resetXformStack.
+ * World matrices of ancestors are cached per prim and time, so cameras parented under the same animated rig only
+ * evaluate the rig once per time. Once every camera is added, ComputeCameraTransform can be called from any thread.
+ */
+class FUSDCameraTransformEvaluator
+{
+public:
+	explicit FUSDCameraTransformEvaluator(const UE::FUsdStage& InStage);
+	~FUSDCameraTransformEvaluator();
+
+	FUSDCameraTransformEvaluator(const FUSDCameraTransformEvaluator&) = delete;
+	FUSDCameraTransformEvaluator& operator=(const FUSDCameraTransformEvaluator&) = delete;
+
+	/**
+	 * Resolves the xformOp stacks of the camera and its ancestors. Not thread safe, add every camera before evaluating.
+	 * @return false if there is no prim at CameraPath
+	 */
+	bool AddCamera(const UE::FSdfPath& CameraPath);
+
+	/**
+	 * World transform of an added camera at Time, converted to the Unreal up axis and units and rotated so the camera
+	 * looks down +X like a CineCameraActor does.
+	 * @return false if the camera wasn't added
+	 */
+	bool ComputeCameraTransform(const UE::FSdfPath& CameraPath, double Time, FTransform& OutTransform) const;
+
+	const UE::FUsdStage& GetStage() const
+	{
+		return Stage;
+	}
+
+	const FUsdStageInfo& GetStageInfo() const
+	{
+		return StageInfo;
+	}
+
+	/** Number of ancestor matrices computed so far, the rest of the lookups were cache hits */
+	int32 GetNumCachedMatrices() const;
+
+private:
+	struct FPrimXform
+	{
+		pxr::UsdGeomXformable::XformQuery Query;
+		int32 ParentIndex = INDEX_NONE;
+		bool bIsXformable = false;
+		bool bResetsXformStack = false;
+
+		/** Whether this prim or any ancestor it inherits from has animated ops */
+		bool bWorldMightBeTimeVarying = false;
+
+		/** Set on ancestors of added cameras, which are the only prims worth caching */
+		bool bIsCached = false;
+	};
+
+	struct FMatrixCacheKey
+	{
+		int32 PrimIndex;
+		double Time;
+
+		bool operator==(const FMatrixCacheKey& Other) const
+		{
+			return PrimIndex == Other.PrimIndex && Time == Other.Time;
+		}
+
+		friend uint32 GetTypeHash(const FMatrixCacheKey& Key)
+		{
+			return HashCombine(::GetTypeHash(Key.PrimIndex), ::GetTypeHash(Key.Time));
+		}
+	};
+
+	int32 FindOrAddPrim(const pxr::UsdPrim& Prim);
+
+	/** Called with the USD allocator active */
+	pxr::GfMatrix4d ComputeLocalToWorld(int32 PrimIndex, double Time) const;
+
+	UE::FUsdStage Stage;
+	FUsdStageInfo StageInfo;
+
+	TArray<FPrimXform> Prims;
+	TMap<UE::FSdfPath, int32> PrimIndices;
+
+	mutable FRWLock MatrixCacheLock;
+	mutable TMap<FMatrixCacheKey, pxr::GfMatrix4d> MatrixCache;
+};
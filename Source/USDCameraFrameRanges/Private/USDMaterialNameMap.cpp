@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDMaterialNameMap.h"
+
+#include "USDCameraFrameRangesLog.h"
+#include "Misc/ConfigCacheIni.h"
+
+FMaterialNameConvention FMaterialNameConvention::LoadFromConfig()
+{
+	FMaterialNameConvention Convention;
+	if (GConfig)
+	{
+		GConfig->GetArray(TEXT("USDCameraFrameRanges"), TEXT("MaterialNamePrefixes"), Convention.Prefixes, GEditorPerProjectIni);
+		GConfig->GetArray(TEXT("USDCameraFrameRanges"), TEXT("MaterialNameSuffixes"), Convention.Suffixes, GEditorPerProjectIni);
+	}
+	return Convention;
+}
+
+FString FMaterialNameConvention::Normalize(const FString& Name) const
+{
+	FString Result = Name;
+	for (const FString& Prefix : Prefixes)
+	{
+		if (Result.RemoveFromStart(Prefix))
+		{
+			break;
+		}
+	}
+	for (const FString& Suffix : Suffixes)
+	{
+		if (Result.RemoveFromEnd(Suffix))
+		{
+			break;
+		}
+	}
+	return Result;
+}
+
+FUSDMaterialNameMap::FUSDMaterialNameMap(const FMaterialNameConvention& InConvention, TArray<FAssetData>&& Materials)
+	: Convention(InConvention)
+{
+	MaterialsByName.Reserve(Materials.Num());
+	for (FAssetData& Material : Materials)
+	{
+		FString Key = Convention.Normalize(Material.AssetName.ToString());
+		if (MaterialsByName.Contains(Key))
+		{
+			UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Material %s has the same name as another material once normalized, ignoring it"), *Material.GetObjectPathString());
+			continue;
+		}
+		MaterialsByName.Add(MoveTemp(Key), MoveTemp(Material));
+	}
+}
+
+const FAssetData* FUSDMaterialNameMap::Find(const FString& USDMaterialName) const
+{
+	return MaterialsByName.Find(Convention.Normalize(USDMaterialName));
+}
@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+
+/**
+ * Maps USD and Unreal material names onto a common key, e.g. so that a USD "Brick" matches a "M_Brick" asset.
+ * Prefixes and suffixes come from the [USDCameraFrameRanges] section of the per project editor settings:
+ *   +MaterialNamePrefixes=M_
+ *   +MaterialNameSuffixes=_Mat
+ */
+struct FMaterialNameConvention
+{
+	TArray<FString> Prefixes;
+	TArray<FString> Suffixes;
+
+	static FMaterialNameConvention LoadFromConfig();
+
+	/** Strips the first matching prefix and suffix */
+	FString Normalize(const FString& Name) const;
+};
+
+/** Project materials keyed by their name once normalized, to match them to the names of USD materials */
+class FUSDMaterialNameMap
+{
+public:
+	/** Materials whose normalized name is already taken are ignored with a warning */
+	FUSDMaterialNameMap(const FMaterialNameConvention& InConvention, TArray<FAssetData>&& Materials);
+
+	/** Ignores case. @return nullptr if no project material has the name of the USD material once normalized */
+	const FAssetData* Find(const FString& USDMaterialName) const;
+
+	int32 Num() const
+	{
+		return MaterialsByName.Num();
+	}
+
+private:
+	FMaterialNameConvention Convention;
+
+	/** FString keys hash and compare ignoring case, so this doubles as a case-insensitive lookup */
+	TMap<FString, FAssetData> MaterialsByName;
+};
@@ -0,0 +1,642 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDStageIndex.h"
+
+#include "USDCameraFrameRangesLog.h"
+#include "USDStageScanner.h"
+#include "Async/Async.h"
+#include "HAL/PlatformProcess.h"
+#include "USDMemory.h"
+#include "USDStageActor.h"
+#include "USDTypesConversion.h"
+#include "UsdWrappers/UsdPrim.h"
+#include "UsdWrappers/UsdStage.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xformable.h"
+#include "USDIncludesEnd.h"
+
+namespace USDStageIndex
+{
+	void MergeTimes(const TArray<double>& A, const TArray<double>& B, TArray<double>& OutTimes)
+	{
+		OutTimes.Reset(A.Num() + B.Num());
+
+		int32 IndexA = 0;
+		int32 IndexB = 0;
+		while (IndexA < A.Num() || IndexB < B.Num())
+		{
+			double Time;
+			if (IndexB == B.Num() || (IndexA < A.Num() && A[IndexA] < B[IndexB]))
+			{
+				Time = A[IndexA++];
+			}
+			else if (IndexA == A.Num() || B[IndexB] < A[IndexA])
+			{
+				Time = B[IndexB++];
+			}
+			else
+			{
+				Time = A[IndexA++];
+				++IndexB;
+			}
+
+			if (OutTimes.Num() == 0 || OutTimes.Last() != Time)
+			{
+				OutTimes.Add(Time);
+			}
+		}
+	}
+
+	namespace Private
+	{
+		/**
+		 * Times at which the world transform of a prim may change: the samples of its own xformOps merged with those
+		 * of its parent, unless it resets the xform stack. Memoized per prim so cameras under the same rig share the
+		 * rig's timeline.
+		 */
+		class FWorldTimelineCache
+		{
+		public:
+			explicit FWorldTimelineCache(const UE::FUsdStage& InStage)
+				: Stage(InStage)
+			{
+			}
+
+			void GetTimeSamples(const UE::FSdfPath& PrimPath, TArray<double>& OutTimes)
+			{
+				OutTimes.Reset();
+
+				if (PrimPath.IsEmpty() || PrimPath.IsAbsoluteRootPath())
+				{
+					return;
+				}
+
+				if (const TArray<double>* CachedTimes = Timelines.Find(PrimPath))
+				{
+					OutTimes = *CachedTimes;
+					return;
+				}
+
+				TArray<double> OwnTimes;
+				bool bResetsXformStack = false;
+				{
+					FScopedUsdAllocs UsdAllocs;
+
+					const pxr::UsdStageRefPtr& UsdStage = Stage;
+					pxr::UsdGeomXformable Xformable(UsdStage->GetPrimAtPath(PrimPath));
+					if (Xformable)
+					{
+						std::vector<double> UsdTimes;
+						Xformable.GetTimeSamples(&UsdTimes);
+						bResetsXformStack = Xformable.GetResetXformStack();
+
+						FScopedUnrealAllocs UnrealAllocs;
+						OwnTimes.Append(UsdTimes.data(), static_cast<int32>(UsdTimes.size()));
+					}
+				}
+
+				if (bResetsXformStack)
+				{
+					OutTimes = MoveTemp(OwnTimes);
+				}
+				else
+				{
+					TArray<double> ParentTimes;
+					GetTimeSamples(PrimPath.GetParentPath(), ParentTimes);
+					MergeTimes(OwnTimes, ParentTimes, OutTimes);
+				}
+
+				Timelines.Add(PrimPath, OutTimes);
+			}
+
+		private:
+			const UE::FUsdStage& Stage;
+			TMap<UE::FSdfPath, TArray<double>> Timelines;
+		};
+
+		bool BuildCameraInfo(const UE::FUsdStage& Stage, const UE::FSdfPath& Path, FWorldTimelineCache& TimelineCache, FCameraInfo& OutCameraInfo)
+		{
+			UE::FUsdPrim CurrentPrim = Stage.GetPrimAtPath(Path);
+			if (!CurrentPrim)
+			{
+				UE_LOG(LogUSDCameraFrameRanges, Warning, TEXT("Failed to get Prim at path: %s"), *Path.GetString());
+				return false;
+			}
+
+			FCameraInfo CameraInfo;
+			CameraInfo.CameraName = CurrentPrim.GetName().ToString();
+			CameraInfo.PrimPath = Path;
+
+			TimelineCache.GetTimeSamples(Path, CameraInfo.TimeSamples);
+
+			// A camera that never moves still gets a one frame range so it can be baked
+			if (CameraInfo.TimeSamples.Num() > 0)
+			{
+				CameraInfo.StartFrame = FMath::FloorToInt32(CameraInfo.TimeSamples[0]);
+				CameraInfo.EndFrame = FMath::CeilToInt32(CameraInfo.TimeSamples.Last());
+			}
+			else
+			{
+				CameraInfo.StartFrame = 1;
+				CameraInfo.EndFrame = 1;
+			}
+
+			OutCameraInfo = MoveTemp(CameraInfo);
+			return true;
+		}
+
+		bool IsAtOrBelow(const UE::FSdfPath& Path, const UE::FSdfPath& Root, bool bRecursive)
+		{
+			const pxr::SdfPath& UsdPath = Path;
+			const pxr::SdfPath& UsdRoot = Root;
+			return bRecursive ? UsdPath.HasPrefix(UsdRoot) : UsdPath == UsdRoot;
+		}
+
+		/** Same as above on the path strings the camera store keeps, so records can be tested without making an SdfPath */
+		bool IsAtOrBelow(FStringView Path, FStringView Root, bool bRecursive)
+		{
+			if (Path.Equals(Root, ESearchCase::CaseSensitive))
+			{
+				return true;
+			}
+			if (!bRecursive)
+			{
+				return false;
+			}
+			if (Root == TEXT("/"))
+			{
+				return true;
+			}
+			return Path.Len() > Root.Len() && Path[Root.Len()] == TEXT('/') && Path.StartsWith(Root, ESearchCase::CaseSensitive);
+		}
+
+		/**
+		 * Which bindings the change of the object at ChangedPath may affect. A binding changes the material of everything
+		 * below the prim it is on, and a resync may add or remove geometry. Anything else, like a transform or a
+		 * visibility edit, leaves every binding as it was.
+		 */
+		EUSDBindingChangeScope GetBindingChangeScope(const UE::FUsdStage& Stage, const pxr::SdfPath& ChangedPath, bool bResync)
+		{
+			if (ChangedPath.IsPropertyPath())
+			{
+				const std::string& PropertyName = ChangedPath.GetName();
+				if (pxr::TfStringStartsWith(PropertyName, "collection:"))
+				{
+					return EUSDBindingChangeScope::Stage;
+				}
+				return pxr::TfStringStartsWith(PropertyName, "material:binding") ? EUSDBindingChangeScope::Subtree : EUSDBindingChangeScope::None;
+			}
+
+			if (bResync)
+			{
+				return EUSDBindingChangeScope::Subtree;
+			}
+
+			// Without a property in the path any binding or collection authored on the prim may be the one that changed.
+			// Removing one is a resync, so a prim that has none left can't have changed a binding
+			const pxr::UsdStageRefPtr& UsdStage = Stage;
+			const pxr::UsdPrim Prim = UsdStage ? UsdStage->GetPrimAtPath(ChangedPath) : pxr::UsdPrim();
+			if (!Prim)
+			{
+				return EUSDBindingChangeScope::None;
+			}
+			if (!Prim.GetAuthoredPropertiesInNamespace("collection").empty())
+			{
+				return EUSDBindingChangeScope::Stage;
+			}
+			if (!Prim.GetAuthoredPropertiesInNamespace("material").empty())
+			{
+				return EUSDBindingChangeScope::Subtree;
+			}
+			return EUSDBindingChangeScope::None;
+		}
+
+		/** @return false if Progress asked to stop before every camera was added */
+		bool AppendCameras(const UE::FUsdStage& Stage, const TArray<UE::FSdfPath>& CameraPaths, FUSDCameraStore& OutCameras,
+			const FUSDScanProgress* Progress = nullptr)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(USDStageIndex::AppendCameras);
+			CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, CameraTimelines);
+
+			FWorldTimelineCache TimelineCache(Stage);
+
+			// Each camera only goes through an FCameraInfo on its way into the store's shared arrays
+			FCameraInfo CameraInfo;
+			for (const UE::FSdfPath& Path : CameraPaths)
+			{
+				if (Progress && Progress->ShouldStop())
+				{
+					return false;
+				}
+
+				if (BuildCameraInfo(Stage, Path, TimelineCache, CameraInfo))
+				{
+					OutCameras.Add(CameraInfo);
+				}
+			}
+			OutCameras.Shrink();
+			return true;
+		}
+	}
+}
+
+FUSDStageIndex::FUSDStageIndex(AUsdStageActor* InStageActor)
+	: StageActor(InStageActor)
+	, Cameras(MakeShared<FUSDCameraStore>())
+{
+	if (InStageActor)
+	{
+		InStageActor->OnPrimChanged.AddRaw(this, &FUSDStageIndex::OnPrimChanged);
+		InStageActor->OnStageChanged.AddRaw(this, &FUSDStageIndex::OnStageChanged);
+	}
+}
+
+FUSDStageIndex::~FUSDStageIndex()
+{
+	if (AUsdStageActor* Actor = StageActor.Get())
+	{
+		Actor->OnPrimChanged.RemoveAll(this);
+		Actor->OnStageChanged.RemoveAll(this);
+	}
+}
+
+TSharedRef<const FUSDCameraStore> FUSDStageIndex::GetCameras()
+{
+	BuildIfNeeded();
+	return Cameras;
+}
+
+const TArray<FMaterialInfo>& FUSDStageIndex::GetMaterialBindings()
+{
+	BuildIfNeeded();
+	return MaterialBindings;
+}
+
+bool FUSDStageIndex::ScanStage(const UE::FUsdStage& Stage, FUSDScanProgress* Progress, FScanResult& OutResult)
+{
+	if (!Stage)
+	{
+		return true;
+	}
+
+	FUSDCameraCollector CameraCollector;
+	FUSDMaterialBindingCollector MaterialCollector;
+
+	FUSDStageScanner Scanner;
+	Scanner.SetProgress(Progress);
+	Scanner.AddCollector(CameraCollector);
+	Scanner.AddCollector(MaterialCollector);
+	if (!Scanner.Scan(Stage.GetPseudoRoot()))
+	{
+		return false;
+	}
+
+	OutResult.NumVisited = Scanner.GetNumVisited();
+	if (!USDStageIndex::Private::AppendCameras(Stage, CameraCollector.CameraPaths, OutResult.Cameras, Progress)
+		|| !MaterialCollector.ResolveBindings(Stage, Progress))
+	{
+		return false;
+	}
+	OutResult.MaterialBindings = MoveTemp(MaterialCollector.MaterialBindings);
+
+	return true;
+}
+
+FUSDCameraStore FUSDStageIndex::CollectCameras(const UE::FUsdStage& Stage, int32* OutNumVisited)
+{
+	FUSDCameraStore Result;
+	if (!Stage)
+	{
+		return Result;
+	}
+
+	// Without the material collector the scanner can prune every geometry subtree
+	FUSDCameraCollector CameraCollector;
+	FUSDStageScanner Scanner;
+	Scanner.AddCollector(CameraCollector);
+	Scanner.Scan(Stage.GetPseudoRoot());
+	if (OutNumVisited)
+	{
+		*OutNumVisited = Scanner.GetNumVisited();
+	}
+
+	USDStageIndex::Private::AppendCameras(Stage, CameraCollector.CameraPaths, Result);
+	return Result;
+}
+
+TArray<FMaterialInfo> FUSDStageIndex::CollectMaterialBindings(const UE::FUsdStage& Stage, int32* OutNumVisited)
+{
+	if (!Stage)
+	{
+		return {};
+	}
+
+	FUSDMaterialBindingCollector MaterialCollector;
+	FUSDStageScanner Scanner;
+	Scanner.AddCollector(MaterialCollector);
+	Scanner.Scan(Stage.GetPseudoRoot());
+	if (OutNumVisited)
+	{
+		*OutNumVisited = Scanner.GetNumVisited();
+	}
+	MaterialCollector.ResolveBindings(Stage);
+
+	return MoveTemp(MaterialCollector.MaterialBindings);
+}
+
+void FUSDStageIndex::BuildIfNeeded()
+{
+	AUsdStageActor* Actor = StageActor.Get();
+	if (!bIsDirty || !Actor)
+	{
+		return;
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FScanResult Result;
+	ScanStage(Actor->GetUsdStage(), nullptr, Result);
+	CommitScan(MoveTemp(Result));
+
+	UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Indexed %d cameras and %d material bindings in %.2f ms"),
+		Cameras->Num(), MaterialBindings.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+}
+
+void FUSDStageIndex::BuildAsync(TSharedRef<FUSDScanProgress> Progress, TFunction<void(bool)> OnCompleted)
+{
+	AUsdStageActor* Actor = StageActor.Get();
+	if (!bIsDirty || !Actor)
+	{
+		OnCompleted(!bIsDirty);
+		return;
+	}
+
+	// A second request while a scan is running waits for that scan rather than starting another one, whose result
+	// would be committed over the first and lose the notices replayed in between
+	if (bIsBuilding)
+	{
+		Build->Callbacks.Add(MoveTemp(OnCompleted));
+		return;
+	}
+
+	bIsBuilding = true;
+	Build = MakeShared<FBuildState>(MoveTemp(Progress));
+	Build->Callbacks.Add(MoveTemp(OnCompleted));
+	StartBuild();
+}
+
+void FUSDStageIndex::StartBuild()
+{
+	AUsdStageActor* Actor = StageActor.Get();
+
+	// The copy keeps the stage alive for the worker even if the actor closes it in the meantime
+	UE::FUsdStage Stage = Actor ? Actor->GetUsdStage() : UE::FUsdStage();
+	TWeakPtr<FUSDStageIndex> WeakThis = AsShared();
+	const uint32 Serial = StageSerial;
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// The build is held by the tasks as well, so its callbacks still run if the index goes away during the scan
+	TSharedRef<FBuildState> BuildState = Build.ToSharedRef();
+	BuildState->Progress->bStageEdited = false;
+	BuildState->bReadingStage = true;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Stage, Serial, StartSeconds, BuildState]() mutable
+	{
+		TSharedRef<FScanResult> Result = MakeShared<FScanResult>();
+		const bool bCompleted = ScanStage(Stage, &BuildState->Progress.Get(), *Result);
+		BuildState->bReadingStage = false;
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result, bCompleted, Serial, StartSeconds, BuildState]()
+		{
+			TSharedPtr<FUSDStageIndex> This = WeakThis.Pin();
+			const bool bCancelled = BuildState->Progress->bCancelRequested;
+
+			// Stopped by an edit, which is done by now, so the same build scans the stage again
+			const bool bStillNeeded = This && Serial == This->StageSerial && This->bIsDirty;
+			if (!bCompleted && !bCancelled && bStillNeeded)
+			{
+				This->PendingChanges.Reset();
+				This->StartBuild();
+				return;
+			}
+
+			bool bSucceeded = bCompleted;
+			if (This)
+			{
+				This->bIsBuilding = false;
+				This->Build.Reset();
+				if (!bCompleted)
+				{
+					This->PendingChanges.Reset();
+
+					// A synchronous build may have committed the index while the edit stopped this one
+					bSucceeded = !bCancelled && !This->bIsDirty;
+				}
+				// A synchronous build may have committed a newer scan in the meantime
+				else if (bStillNeeded)
+				{
+					This->CommitScan(MoveTemp(*Result));
+
+					UE_LOG(LogUSDCameraFrameRanges, Log, TEXT("Indexed %d cameras and %d material bindings in the background in %.2f ms"),
+						This->Cameras->Num(), This->MaterialBindings.Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+				}
+			}
+
+			for (const TFunction<void(bool)>& OnCompleted : BuildState->Callbacks)
+			{
+				OnCompleted(bSucceeded);
+			}
+		});
+	});
+}
+
+void FUSDStageIndex::StopBuildReadingStage()
+{
+	Build->Progress->bStageEdited = true;
+
+	// The worker checks between every prim, camera and binding it reads, so this doesn't wait for more than one of them
+	while (Build->bReadingStage.load())
+	{
+		FPlatformProcess::Yield();
+	}
+}
+
+void FUSDStageIndex::CommitScan(FScanResult&& Result)
+{
+	Cameras = MakeShared<FUSDCameraStore>(MoveTemp(Result.Cameras));
+	MaterialBindings = MoveTemp(Result.MaterialBindings);
+	EstimatedNumPrims = Result.NumVisited;
+	bIsDirty = false;
+
+	for (const FPrimChange& Change : PendingChanges)
+	{
+		Refresh(Change);
+	}
+	PendingChanges.Reset();
+
+	OnCamerasChanged.Broadcast(UE::FSdfPath(TEXT("/")));
+}
+
+void FUSDStageIndex::OnPrimChanged(const FString& ChangedPath, bool bResync)
+{
+	// Nothing to patch until the first full build
+	if (bIsDirty && !bIsBuilding)
+	{
+		return;
+	}
+
+	AUsdStageActor* Actor = StageActor.Get();
+	if (!Actor)
+	{
+		return;
+	}
+
+	// The stage recomposed for this edit and more editing may follow as soon as this returns, so the background scan
+	// must not read it any further
+	if (bIsBuilding)
+	{
+		StopBuildReadingStage();
+	}
+
+	// The binding scope is worked out now, while the property that changed is still known
+	FPrimChange Change;
+	Change.bResync = bResync;
+	{
+		FScopedUsdAllocs UsdAllocs;
+		pxr::SdfPath UsdPath(UnrealToUsd::ConvertString(*ChangedPath).Get());
+		Change.BindingScope = USDStageIndex::Private::GetBindingChangeScope(Actor->GetUsdStage(), UsdPath, bResync);
+
+		FScopedUnrealAllocs UnrealAllocs;
+		Change.PrimPath = UE::FSdfPath(UsdPath.GetAbsoluteRootOrPrimPath());
+	}
+
+	// Once a synchronous build has committed, a background one still running gets discarded and has nothing to replay
+	if (bIsDirty)
+	{
+		PendingChanges.Add(MoveTemp(Change));
+		return;
+	}
+
+	Refresh(Change);
+}
+
+void FUSDStageIndex::OnStageChanged()
+{
+	bIsDirty = true;
+	++StageSerial;
+	PendingChanges.Reset();
+}
+
+void FUSDStageIndex::Refresh(const FPrimChange& Change)
+{
+	AUsdStageActor* Actor = StageActor.Get();
+	if (!Actor)
+	{
+		return;
+	}
+
+	// A resync may have added or removed whole subtrees, anything else only changed values on the prim itself
+	const UE::FUsdStage& Stage = Actor->GetUsdStage();
+	RefreshCameras(Stage, Change.PrimPath, Change.bResync);
+
+	if (Change.BindingScope == EUSDBindingChangeScope::Subtree)
+	{
+		RefreshMaterialBindings(Stage, Change.PrimPath);
+	}
+	else if (Change.BindingScope == EUSDBindingChangeScope::Stage && Stage)
+	{
+		RefreshMaterialBindings(Stage, Stage.GetPseudoRoot().GetPrimPath());
+	}
+
+	UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Refreshed index entries at %s%s%s"), *Change.PrimPath.GetString(), Change.bResync ? TEXT(" and below") : TEXT(""),
+		Change.BindingScope == EUSDBindingChangeScope::None ? TEXT("") : TEXT(", with material bindings"));
+}
+
+void FUSDStageIndex::RefreshCameras(const UE::FUsdStage& Stage, const UE::FSdfPath& PrimPath, bool bRecursive)
+{
+	// Cameras inherit the timeline of their ancestors, so those below a changed prim are rebuilt even when the change
+	// doesn't touch the hierarchy
+	const FString RootPath = PrimPath.GetString();
+	int32 NumAffected = 0;
+	TArray<UE::FSdfPath> CameraPaths;
+	for (const FUSDCameraRecord& Camera : Cameras->GetRecords())
+	{
+		const FStringView CameraPath = Cameras->GetPrimPathString(Camera);
+		if (USDStageIndex::Private::IsAtOrBelow(CameraPath, RootPath, true))
+		{
+			++NumAffected;
+			if (!bRecursive && !USDStageIndex::Private::IsAtOrBelow(CameraPath, RootPath, false))
+			{
+				CameraPaths.Add(Cameras->GetPrimPath(Camera));
+			}
+		}
+	}
+
+	FUSDCameraCollector CameraCollector;
+	if (UE::FUsdPrim Prim = Stage ? Stage.GetPrimAtPath(PrimPath) : UE::FUsdPrim())
+	{
+		if (bRecursive)
+		{
+			FUSDStageScanner Scanner;
+			Scanner.AddCollector(CameraCollector);
+			Scanner.Scan(Prim);
+		}
+		else
+		{
+			FScopedUsdAllocs UsdAllocs;
+			const pxr::UsdPrim& UsdPrim = Prim;
+			CameraCollector.VisitPrim(UsdPrim);
+		}
+	}
+
+	// Most changes are to geometry, which leaves the cameras and whoever references their store alone
+	if (NumAffected == 0 && CameraCollector.CameraPaths.Num() == 0)
+	{
+		return;
+	}
+
+	// The current store may be referenced by the tab or a bake, so the unaffected records are copied as they are into a
+	// new one and only the affected cameras get their timeline computed again
+	TSharedRef<FUSDCameraStore> NewCameras = MakeShared<FUSDCameraStore>();
+	NewCameras->Reserve(Cameras->Num() - NumAffected + CameraPaths.Num() + CameraCollector.CameraPaths.Num(), 0);
+	for (const FUSDCameraRecord& Camera : Cameras->GetRecords())
+	{
+		if (!USDStageIndex::Private::IsAtOrBelow(Cameras->GetPrimPathString(Camera), RootPath, true))
+		{
+			NewCameras->Add(*Cameras, Camera);
+		}
+	}
+
+	CameraPaths.Append(MoveTemp(CameraCollector.CameraPaths));
+	USDStageIndex::Private::AppendCameras(Stage, CameraPaths, *NewCameras);
+	Cameras = NewCameras;
+
+	OnCamerasChanged.Broadcast(PrimPath);
+}
+
+void FUSDStageIndex::RefreshMaterialBindings(const UE::FUsdStage& Stage, const UE::FSdfPath& RootPath)
+{
+	// Geometry inherits the bindings of its ancestors, so the whole subtree is resolved again and not just RootPath
+	MaterialBindings.RemoveAll([&RootPath](const FMaterialInfo& Binding)
+	{
+		return USDStageIndex::Private::IsAtOrBelow(Binding.PrimPath, RootPath, true);
+	});
+
+	UE::FUsdPrim Prim = Stage ? Stage.GetPrimAtPath(RootPath) : UE::FUsdPrim();
+	if (!Prim)
+	{
+		return;
+	}
+
+	FUSDMaterialBindingCollector MaterialCollector;
+	FUSDStageScanner Scanner;
+	Scanner.AddCollector(MaterialCollector);
+	Scanner.Scan(Prim);
+
+	MaterialCollector.ResolveBindings(Stage);
+	MaterialBindings.Append(MoveTemp(MaterialCollector.MaterialBindings));
+}
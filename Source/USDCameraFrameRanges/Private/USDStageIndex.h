@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraFrameRanges.h"
+#include "USDCameraStore.h"
+
+#include <atomic>
+
+class AUsdStageActor;
+struct FUSDScanProgress;
+
+namespace UE
+{
+	class FUsdStage;
+}
+
+namespace USDStageIndex
+{
+	/** Merges two sorted time arrays into OutTimes, dropping duplicates */
+	void MergeTimes(const TArray<double>& A, const TArray<double>& B, TArray<double>& OutTimes);
+}
+
+/** The cameras at or below the path were replaced by a new store, the path being the absolute root after a full build */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnUSDStageIndexCamerasChanged, const UE::FSdfPath& /* RootPath */);
+
+/** Which of the resolved material bindings a change to a prim may affect */
+enum class EUSDBindingChangeScope : uint8
+{
+	None,
+	/** The bindings of the geometry at or below the changed prim */
+	Subtree,
+	/** Every binding, as a collection may be targeted by bindings anywhere on the stage */
+	Stage,
+};
+
+/**
+ * Cameras and material bindings of the stage opened by a stage actor.
+ * Built by one full scan on first use, then kept up to date from the actor's prim change notices by only rescanning
+ * the prims that changed. Loading a different stage invalidates the whole index.
+ */
+class FUSDStageIndex : public TSharedFromThis<FUSDStageIndex>
+{
+public:
+	explicit FUSDStageIndex(AUsdStageActor* InStageActor);
+	~FUSDStageIndex();
+
+	FUSDStageIndex(const FUSDStageIndex&) = delete;
+	FUSDStageIndex& operator=(const FUSDStageIndex&) = delete;
+
+	AUsdStageActor* GetStageActor() const
+	{
+		return StageActor.Get();
+	}
+
+	bool IsBuilt() const
+	{
+		return !bIsDirty;
+	}
+
+	bool IsBuilding() const
+	{
+		return bIsBuilding;
+	}
+
+	/** Prim count of the previous full scan of this stage, 0 if it was never scanned */
+	int32 GetEstimatedNumPrims() const
+	{
+		return EstimatedNumPrims;
+	}
+
+	/**
+	 * Builds the index on the calling thread if needed. Changes to the stage replace the store rather than editing it,
+	 * so a store handed out stays valid and unchanged for as long as it is referenced
+	 */
+	TSharedRef<const FUSDCameraStore> GetCameras();
+	const TArray<FMaterialInfo>& GetMaterialBindings();
+
+	/**
+	 * Scans the stage on a worker thread and commits the result on the game thread.
+	 * OnCompleted runs on the game thread with false if the scan was cancelled through Progress. A call made while a
+	 * scan is already running joins it: its OnCompleted runs when that scan ends, and it is the first call's Progress
+	 * that gets updated and can cancel the scan. A stage can't be read while it recomposes, so an edit of the stage
+	 * stops the worker before the game thread goes on, and the scan starts over once the edit is done.
+	 */
+	void BuildAsync(TSharedRef<FUSDScanProgress> Progress, TFunction<void(bool)> OnCompleted);
+
+	/**
+	 * Cameras or material bindings of a stage no actor has opened, each from a scan that only looks for them.
+	 * Only read USD data, so they can run on any thread
+	 * @param OutNumVisited Prims the scan visited, which leaves out the subtrees it could prune
+	 */
+	static FUSDCameraStore CollectCameras(const UE::FUsdStage& Stage, int32* OutNumVisited = nullptr);
+	static TArray<FMaterialInfo> CollectMaterialBindings(const UE::FUsdStage& Stage, int32* OutNumVisited = nullptr);
+
+	/**
+	 * Broadcast once the store is replaced. Unlike the stage actor's prim notices, GetCameras already returns the new
+	 * store by then, so listeners should use this rather than the notices to follow changes to cameras
+	 */
+	FOnUSDStageIndexCamerasChanged OnCamerasChanged;
+
+private:
+	struct FPrimChange
+	{
+		UE::FSdfPath PrimPath;
+		bool bResync = false;
+		EUSDBindingChangeScope BindingScope = EUSDBindingChangeScope::None;
+	};
+
+	/** The running background build, shared with its worker */
+	struct FBuildState
+	{
+		explicit FBuildState(TSharedRef<FUSDScanProgress> InProgress)
+			: Progress(MoveTemp(InProgress))
+		{
+		}
+
+		TSharedRef<FUSDScanProgress> Progress;
+
+		/** Callbacks of every BuildAsync call waiting for this build */
+		TArray<TFunction<void(bool)>> Callbacks;
+
+		/** Set while the worker may still read the stage */
+		std::atomic<bool> bReadingStage{false};
+	};
+
+	struct FScanResult
+	{
+		FUSDCameraStore Cameras;
+		TArray<FMaterialInfo> MaterialBindings;
+		int32 NumVisited = 0;
+	};
+
+	/** Only reads USD data, so it can run on any thread */
+	static bool ScanStage(const UE::FUsdStage& Stage, FUSDScanProgress* Progress, FScanResult& OutResult);
+
+	void BuildIfNeeded();
+
+	/** Scans the stage for the running build on a worker thread */
+	void StartBuild();
+
+	/** Stops the worker of the running build and waits for it to let go of the stage */
+	void StopBuildReadingStage();
+
+	void CommitScan(FScanResult&& Result);
+	void OnPrimChanged(const FString& ChangedPath, bool bResync);
+	void OnStageChanged();
+
+	/**
+	 * Drops the cameras at the changed prim, or below it on a resync, then scans those prims again. Material bindings
+	 * are only resolved again when the change may have affected them
+	 */
+	void Refresh(const FPrimChange& Change);
+
+	/** Swaps in a new store with the affected cameras rebuilt, keeps the current one if no camera is affected */
+	void RefreshCameras(const UE::FUsdStage& Stage, const UE::FSdfPath& PrimPath, bool bRecursive);
+
+	/** Resolves the materials of the geometry at or below RootPath again */
+	void RefreshMaterialBindings(const UE::FUsdStage& Stage, const UE::FSdfPath& RootPath);
+
+	TWeakObjectPtr<AUsdStageActor> StageActor;
+	bool bIsDirty = true;
+	bool bIsBuilding = false;
+
+	/** Bumped whenever the stage changes so a background build of the previous stage gets discarded */
+	uint32 StageSerial = 0;
+	int32 EstimatedNumPrims = 0;
+
+	/** The running background build, null when there is none */
+	TSharedPtr<FBuildState> Build;
+
+	/** Notices received while a background build was running, replayed once it is committed */
+	TArray<FPrimChange> PendingChanges;
+
+	TSharedRef<const FUSDCameraStore> Cameras;
+	TArray<FMaterialInfo> MaterialBindings;
+};
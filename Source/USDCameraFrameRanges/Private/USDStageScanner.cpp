@@ -0,0 +1,272 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDStageScanner.h"
+
+#include "USDCameraFrameRangesLog.h"
+#include "USDMemory.h"
+#include "USDTypesConversion.h"
+#include "Async/ParallelFor.h"
+#include "UsdWrappers/UsdPrim.h"
+#include "UsdWrappers/UsdStage.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/usd/usd/relationship.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/camera.h"
+#include "pxr/usd/usdGeom/gprim.h"
+#include "pxr/usd/usdShade/material.h"
+#include "pxr/usd/usdShade/materialBindingAPI.h"
+#include "pxr/usd/usdShade/nodeGraph.h"
+#include "pxr/usd/usdShade/shader.h"
+#include "pxr/usd/usdShade/tokens.h"
+#include "USDIncludesEnd.h"
+
+TRACE_DECLARE_INT_COUNTER(USDCameraFrameRanges_PrimsVisited, TEXT("USDCameraFrameRanges/PrimsVisited"));
+TRACE_DECLARE_INT_COUNTER(USDCameraFrameRanges_BindingsResolved, TEXT("USDCameraFrameRanges/BindingsResolved"));
+
+namespace USDStageScanner
+{
+	namespace Private
+	{
+		/** Collected prims resolved by one task, enough for the shared caches to outweigh the scheduling */
+		constexpr int32 BindingResolveChunkSize = 256;
+
+		/** Whether the subtree below Prim may hold a camera */
+		bool CanContainCameras(const pxr::UsdPrim& Prim)
+		{
+			// Geometry, materials and shaders never parent cameras. Model kinds say nothing about it: a component is a
+			// leaf of the model hierarchy, yet camera rigs, vehicles and turntables are published as components
+			return !Prim.IsA<pxr::UsdGeomGprim>() && !Prim.IsA<pxr::UsdShadeNodeGraph>() && !Prim.IsA<pxr::UsdShadeShader>();
+		}
+	}
+}
+
+bool FUSDCameraCollector::VisitPrim(const pxr::UsdPrim& Prim)
+{
+	if (Prim.IsA<pxr::UsdGeomCamera>())
+	{
+		FScopedUnrealAllocs UnrealAllocs;
+		const UE::FSdfPath& Path = CameraPaths.Emplace_GetRef(Prim.GetPrimPath());
+		UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Camera found at path: %s"), *Path.GetString());
+
+		// Cameras are never nested under other cameras
+		return false;
+	}
+
+	return USDStageScanner::Private::CanContainCameras(Prim);
+}
+
+bool FUSDMaterialBindingCollector::VisitPrim(const pxr::UsdPrim& Prim)
+{
+	// Materials are only assigned to the meshes made from geometry, and nothing below a material is ever bound
+	if (Prim.IsA<pxr::UsdShadeNodeGraph>() || Prim.IsA<pxr::UsdShadeShader>())
+	{
+		return false;
+	}
+
+	if (Prim.IsA<pxr::UsdGeomGprim>())
+	{
+		FScopedUnrealAllocs UnrealAllocs;
+		GeometryPaths.Emplace(Prim.GetPrimPath());
+
+		// Gprims don't nest, and the subsets below them aren't swapped separately
+		return false;
+	}
+
+	return true;
+}
+
+bool FUSDMaterialBindingCollector::ResolveBindings(const UE::FUsdStage& Stage, const FUSDScanProgress* Progress)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDMaterialBindingCollector::ResolveBindings);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, BindingResolve);
+
+	MaterialBindings.Reset();
+	if (!Stage || GeometryPaths.Num() == 0)
+	{
+		return true;
+	}
+
+	// The scan is depth first, so a chunk is a run of siblings and cousins whose ancestors' bindings are cached by
+	// whichever task reaches them first
+	const int32 NumChunks = FMath::DivideAndRoundUp(GeometryPaths.Num(), USDStageScanner::Private::BindingResolveChunkSize);
+	TArray<TArray<FMaterialInfo>> ChunkBindings;
+	ChunkBindings.SetNum(NumChunks);
+
+	{
+		FScopedUsdAllocs UsdAllocs;
+
+		// Both caches are concurrent maps, documented as safe to share between threads resolving bindings
+		pxr::UsdShadeMaterialBindingAPI::BindingsCache BindingsCache;
+		pxr::UsdShadeMaterialBindingAPI::CollectionQueryCache CollectionQueryCache;
+		const pxr::UsdStageRefPtr& UsdStage = Stage;
+
+		ParallelFor(NumChunks, [this, &ChunkBindings, &BindingsCache, &CollectionQueryCache, &UsdStage, Progress](int32 ChunkIndex)
+		{
+			FScopedUsdAllocs ChunkUsdAllocs;
+
+			const int32 FirstIndex = ChunkIndex * USDStageScanner::Private::BindingResolveChunkSize;
+			const int32 LastIndex = FMath::Min(FirstIndex + USDStageScanner::Private::BindingResolveChunkSize, GeometryPaths.Num());
+			for (int32 Index = FirstIndex; Index < LastIndex; ++Index)
+			{
+				if (Progress && Progress->ShouldStop())
+				{
+					return;
+				}
+
+				const pxr::UsdPrim Prim = UsdStage->GetPrimAtPath(GeometryPaths[Index]);
+				if (!Prim)
+				{
+					continue;
+				}
+
+				// Unreal renders at full quality, which falls back to the all-purpose binding when there's no full one
+				const pxr::UsdShadeMaterial Material = pxr::UsdShadeMaterialBindingAPI(Prim).ComputeBoundMaterial(&BindingsCache, &CollectionQueryCache,
+					pxr::UsdShadeTokens->full);
+				if (!Material)
+				{
+					continue;
+				}
+
+				FScopedUnrealAllocs UnrealAllocs;
+
+				// Named after the material itself rather than one of its shaders, which are usually called after their type
+				FMaterialInfo& MaterialInfo = ChunkBindings[ChunkIndex].AddDefaulted_GetRef();
+				MaterialInfo.ObjName = UsdToUnreal::ConvertToken(Prim.GetName());
+				MaterialInfo.MatName = UsdToUnreal::ConvertToken(Material.GetPrim().GetName());
+				MaterialInfo.PrimPath = GeometryPaths[Index];
+				MaterialInfo.MaterialPath = UE::FSdfPath(Material.GetPath());
+
+				UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Adding material info, ObjName: %s MatName: %s PrimPath: %s"), *MaterialInfo.ObjName, *MaterialInfo.MatName, *MaterialInfo.PrimPath.GetString());
+			}
+		});
+	}
+
+	// Some chunks may have stopped halfway, so none of them are kept
+	if (Progress && Progress->ShouldStop())
+	{
+		return false;
+	}
+
+	int32 NumBindings = 0;
+	for (const TArray<FMaterialInfo>& Bindings : ChunkBindings)
+	{
+		NumBindings += Bindings.Num();
+	}
+
+	MaterialBindings.Reserve(NumBindings);
+	for (TArray<FMaterialInfo>& Bindings : ChunkBindings)
+	{
+		MaterialBindings.Append(MoveTemp(Bindings));
+	}
+
+	USD_CAMERA_FRAME_RANGES_COUNTER_ADD(BindingsResolved, NumBindings);
+
+	UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Resolved %d material bindings for %d geometry prims"), NumBindings, GeometryPaths.Num());
+	return true;
+}
+
+void FUSDStageScanner::AddCollector(IUSDPrimCollector& Collector)
+{
+	FCollectorState& State = Collectors.AddDefaulted_GetRef();
+	State.Collector = &Collector;
+}
+
+bool FUSDStageScanner::Scan(const UE::FUsdPrim& RootPrim)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUSDStageScanner::Scan);
+	CSV_SCOPED_TIMING_STAT(USDCameraFrameRanges, StageScan);
+
+	NumVisited = 0;
+	NumPruned = 0;
+
+	if (!RootPrim || Collectors.Num() == 0)
+	{
+		return true;
+	}
+
+	// How many prims go by between two progress updates, so the shared counter stays off the hot path
+	constexpr int32 ProgressInterval = 1024;
+	bool bCancelled = false;
+
+	{
+		FScopedUsdAllocs UsdAllocs;
+
+		// Unloaded payloads are let through the predicate so they can be pruned and counted explicitly. The range never
+		// descends into instance prototypes since instance proxies aren't requested
+		pxr::UsdPrimRange PrimRange(RootPrim, pxr::UsdPrimIsActive && pxr::UsdPrimIsDefined && !pxr::UsdPrimIsAbstract);
+		for (pxr::UsdPrimRange::iterator PrimIt = PrimRange.begin(); PrimIt != PrimRange.end(); ++PrimIt)
+		{
+			// Checked on every prim, as an edit of the stage must stop the scan before it reads anything else
+			if (Progress && Progress->ShouldStop())
+			{
+				bCancelled = true;
+				break;
+			}
+
+			const pxr::UsdPrim& Prim = *PrimIt;
+			++NumVisited;
+
+			if (Progress && NumVisited % ProgressInterval == 0)
+			{
+				Progress->NumVisited.store(NumVisited, std::memory_order_relaxed);
+			}
+
+			if (!Prim.IsLoaded())
+			{
+				PrimIt.PruneChildren();
+				++NumPruned;
+				continue;
+			}
+
+			// The range is depth first, so a collector becomes active again as soon as we leave the subtree it declined
+			const pxr::SdfPath& PrimPath = Prim.GetPath();
+			bool bAnyInterested = false;
+			for (FCollectorState& State : Collectors)
+			{
+				if (!State.PrunedRoot.IsEmpty())
+				{
+					if (PrimPath.HasPrefix(State.PrunedRoot))
+					{
+						continue;
+					}
+					State.PrunedRoot = pxr::SdfPath();
+				}
+
+				if (State.Collector->VisitPrim(Prim))
+				{
+					bAnyInterested = true;
+				}
+				else
+				{
+					State.PrunedRoot = PrimPath;
+				}
+			}
+
+			if (!bAnyInterested)
+			{
+				PrimIt.PruneChildren();
+				++NumPruned;
+			}
+		}
+
+		for (FCollectorState& State : Collectors)
+		{
+			State.PrunedRoot = pxr::SdfPath();
+		}
+	}
+
+	if (Progress)
+	{
+		Progress->NumVisited.store(NumVisited, std::memory_order_relaxed);
+	}
+
+	USD_CAMERA_FRAME_RANGES_COUNTER_ADD(PrimsVisited, NumVisited);
+
+	// Also runs for every refreshed subtree, so it stays out of the default log
+	UE_LOG(LogUSDCameraFrameRanges, Verbose, TEXT("Stage scan %s after visiting %d prims and pruning %d subtrees for %d collectors"),
+		bCancelled ? TEXT("cancelled") : TEXT("completed"), NumVisited, NumPruned, Collectors.Num());
+
+	return !bCancelled;
+}
@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraFrameRanges.h"
+
+#include <atomic>
+
+#include "USDIncludesStart.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "USDIncludesEnd.h"
+
+struct FUSDScanProgress;
+
+namespace UE
+{
+	class FUsdPrim;
+	class FUsdStage;
+}
+
+/**
+ * Receives the prims visited by FUSDStageScanner.
+ * VisitPrim is called with the USD allocator active, so wrap any Unreal allocation in FScopedUnrealAllocs.
+ */
+class IUSDPrimCollector
+{
+public:
+	virtual ~IUSDPrimCollector() = default;
+
+	/** @return false if nothing below Prim is of interest to this collector, which then won't see its descendants */
+	virtual bool VisitPrim(const pxr::UsdPrim& Prim) = 0;
+};
+
+/** Collects the paths of every camera prim */
+class FUSDCameraCollector : public IUSDPrimCollector
+{
+public:
+	virtual bool VisitPrim(const pxr::UsdPrim& Prim) override;
+
+	TArray<UE::FSdfPath> CameraPaths;
+};
+
+/**
+ * Collects the geometry a material can be assigned to while scanning, then resolves the material bound to each of it
+ * with ResolveBindings.
+ * Resolution follows the UsdShade binding rules: bindings inherited from ancestors, collection-based bindings and
+ * bindingStrength, with a purpose-specific "full" binding preferred over the all-purpose one.
+ */
+class FUSDMaterialBindingCollector : public IUSDPrimCollector
+{
+public:
+	virtual bool VisitPrim(const pxr::UsdPrim& Prim) override;
+
+	/**
+	 * Fills MaterialBindings with one entry per collected prim that has a material bound, in scan order.
+	 * Runs in parallel over runs of neighbouring prims, which all share one binding and collection cache so each
+	 * ancestor's bindings and each collection's membership query are only computed once.
+	 * @return false, with no bindings, if Progress asked to stop before every prim was resolved
+	 */
+	bool ResolveBindings(const UE::FUsdStage& Stage, const FUSDScanProgress* Progress = nullptr);
+
+	TArray<FMaterialInfo> MaterialBindings;
+
+private:
+	TArray<UE::FSdfPath> GeometryPaths;
+};
+
+/** Shared between a scan running on a worker thread and the UI following it */
+struct FUSDScanProgress
+{
+	std::atomic<int32> NumVisited{0};
+	std::atomic<bool> bCancelRequested{false};
+
+	/**
+	 * Set when the stage gets edited during the scan. A stage can't be read while it recomposes, so the scan stops at
+	 * the next prim and whoever started it scans again once the edit is done
+	 */
+	std::atomic<bool> bStageEdited{false};
+
+	bool ShouldStop() const
+	{
+		return bCancelRequested.load(std::memory_order_relaxed) || bStageEdited.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Walks a stage once, handing each prim to every registered collector.
+ * A subtree is only pruned once all collectors have lost interest in it.
+ */
+class FUSDStageScanner
+{
+public:
+	void AddCollector(IUSDPrimCollector& Collector);
+
+	/** Publishes the visited count to Progress while scanning, and stops at the next prim once it asks to */
+	void SetProgress(FUSDScanProgress* InProgress)
+	{
+		Progress = InProgress;
+	}
+
+	/**
+	 * Visits every active, defined and loaded prim below RootPrim.
+	 * @return false if the scan was cancelled before completing
+	 */
+	bool Scan(const UE::FUsdPrim& RootPrim);
+
+	int32 GetNumVisited() const
+	{
+		return NumVisited;
+	}
+
+	int32 GetNumPruned() const
+	{
+		return NumPruned;
+	}
+
+private:
+	struct FCollectorState
+	{
+		IUSDPrimCollector* Collector = nullptr;
+
+		/** Root of the subtree this collector declined, empty while it is active */
+		pxr::SdfPath PrunedRoot;
+	};
+
+	TArray<FCollectorState> Collectors;
+	FUSDScanProgress* Progress = nullptr;
+	int32 NumVisited = 0;
+	int32 NumPruned = 0;
+};
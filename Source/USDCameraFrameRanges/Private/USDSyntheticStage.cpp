@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDSyntheticStage.h"
+
+#include "UnrealUSDWrapper.h"
+#include "USDMemory.h"
+
+#include "USDIncludesStart.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/camera.h"
+#include "pxr/usd/usdGeom/cube.h"
+#include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/usd/usdGeom/xform.h"
+#include "pxr/usd/usdShade/material.h"
+#include "pxr/usd/usdShade/materialBindingAPI.h"
+#include "pxr/usd/usdShade/shader.h"
+#include "USDIncludesEnd.h"
+
+namespace USDSyntheticStage
+{
+	UE::FUsdStage Create(const FUSDSyntheticStageSettings& Settings)
+	{
+		UE::FUsdStage Stage = UnrealUSDWrapper::NewStage();
+		if (!Stage)
+		{
+			return Stage;
+		}
+
+		FScopedUsdAllocs UsdAllocs;
+
+		pxr::UsdStageRefPtr UsdStage = Stage;
+		pxr::UsdGeomSetStageUpAxis(UsdStage, pxr::UsdGeomTokens->z);
+		UsdStage->SetTimeCodesPerSecond(24.0);
+		UsdStage->SetStartTimeCode(1.0);
+		UsdStage->SetEndTimeCode(Settings.NumSamples);
+
+		pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/World"));
+
+		const int32 NumMaterials = Settings.GetNumMaterials();
+		std::vector<pxr::UsdShadeMaterial> Materials;
+		Materials.reserve(NumMaterials);
+		for (int32 Index = 0; Index < NumMaterials; ++Index)
+		{
+			const pxr::SdfPath MaterialPath(pxr::TfStringPrintf("/World/Looks/Material_%d", Index));
+			Materials.push_back(pxr::UsdShadeMaterial::Define(UsdStage, MaterialPath));
+			pxr::UsdShadeShader::Define(UsdStage, MaterialPath.AppendChild(pxr::TfToken("Shader")));
+		}
+
+		constexpr int32 PrimsPerGroup = 100;
+		pxr::SdfPath GroupPath;
+		for (int32 Index = 0; Index < Settings.NumPrims; ++Index)
+		{
+			if (Index % PrimsPerGroup == 0)
+			{
+				GroupPath = pxr::SdfPath(pxr::TfStringPrintf("/World/Set/Group_%d", Index / PrimsPerGroup));
+				pxr::UsdGeomXform::Define(UsdStage, GroupPath);
+			}
+
+			pxr::UsdGeomCube Cube = pxr::UsdGeomCube::Define(UsdStage, GroupPath.AppendChild(pxr::TfToken(pxr::TfStringPrintf("Cube_%d", Index))));
+			if (Index < Settings.NumBindings)
+			{
+				pxr::UsdShadeMaterialBindingAPI::Apply(Cube.GetPrim()).Bind(Materials[Index % NumMaterials]);
+			}
+		}
+
+		pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/World/Cameras"));
+		pxr::UsdGeomXform Rig = pxr::UsdGeomXform::Define(UsdStage, pxr::SdfPath("/World/Rig"));
+		pxr::UsdGeomXformOp RigTranslateOp = Rig.AddTranslateOp();
+		for (int32 Sample = 0; Sample < Settings.NumSamples; Sample += 2)
+		{
+			RigTranslateOp.Set(pxr::GfVec3d(Sample * 10.0, 0.0, 0.0), pxr::UsdTimeCode(1.0 + Sample));
+		}
+
+		for (int32 Index = 0; Index < Settings.NumCameras; ++Index)
+		{
+			const char* ParentPath = Index % 2 == 0 ? "/World/Cameras" : "/World/Rig";
+			pxr::UsdGeomCamera Camera = pxr::UsdGeomCamera::Define(UsdStage, pxr::SdfPath(pxr::TfStringPrintf("%s/Camera_%d", ParentPath, Index)));
+
+			pxr::UsdGeomXformOp TranslateOp = Camera.AddTranslateOp();
+			pxr::UsdGeomXformOp RotateOp = Camera.AddRotateXYZOp();
+			pxr::UsdAttribute FocalLengthAttr = Camera.GetFocalLengthAttr();
+
+			// Smooth curves with a per camera phase, so key reduction has something realistic to work on
+			for (int32 Sample = 0; Sample < Settings.NumSamples; ++Sample)
+			{
+				const double Phase = Sample * 0.05 + Index;
+				const pxr::UsdTimeCode Time(1.0 + Sample);
+				TranslateOp.Set(pxr::GfVec3d(FMath::Sin(Phase) * 100.0, FMath::Cos(Phase) * 100.0, 150.0 + Sample), Time);
+				RotateOp.Set(pxr::GfVec3f(80.0f, 0.0f, static_cast<float>(Phase * 10.0)), Time);
+				FocalLengthAttr.Set(static_cast<float>(35.0 + FMath::Sin(Phase) * 5.0), Time);
+			}
+		}
+
+		return Stage;
+	}
+
+	FString GetCameraPath(int32 CameraIndex)
+	{
+		return FString::Printf(TEXT("%s/Camera_%d"), CameraIndex % 2 == 0 ? TEXT("/World/Cameras") : TEXT("/World/Rig"), CameraIndex);
+	}
+}
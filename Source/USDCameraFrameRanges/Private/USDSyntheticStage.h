@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UsdWrappers/UsdStage.h"
+
+/** Size of a stage made by USDSyntheticStage::Create */
+struct FUSDSyntheticStageSettings
+{
+	int32 NumPrims = 100000;
+	int32 NumCameras = 100;
+	int32 NumSamples = 240;
+	int32 NumBindings = 10000;
+
+	/** Materials under /World/Looks the bindings cycle through */
+	int32 GetNumMaterials() const
+	{
+		return FMath::Clamp(NumBindings, 1, 64);
+	}
+};
+
+namespace USDSyntheticStage
+{
+	/**
+	 * Authors an in memory stage of 24 time codes per second, Z up: /World/Set holds the cubes in groups of a hundred,
+	 * the first NumBindings of them bound to one of the materials /World/Looks/Material_<Index>. Even cameras are
+	 * /World/Cameras/Camera_<Index> and odd ones /World/Rig/Camera_<Index>, the rig being animated on every other
+	 * frame so the cameras below it get a merged timeline. Every camera is keyed on time codes 1 to NumSamples.
+	 * @return An invalid stage if it couldn't be created
+	 */
+	UE::FUsdStage Create(const FUSDSyntheticStageSettings& Settings);
+
+	/** Path of the camera of that index on a synthetic stage */
+	FString GetCameraPath(int32 CameraIndex);
+}
@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "USDTimeMapping.h"
+
+#include "UsdWrappers/UsdStage.h"
+
+namespace USDTimeMapping
+{
+	namespace Private
+	{
+		int64 GreatestCommonDivisor(int64 A, int64 B)
+		{
+			while (B != 0)
+			{
+				const int64 Remainder = A % B;
+				A = B;
+				B = Remainder;
+			}
+			return A;
+		}
+
+		/** Rounds towards negative infinity, unlike the / operator which rounds towards zero */
+		int64 FloorDivide(int64 Dividend, int64 Divisor)
+		{
+			const int64 Quotient = Dividend / Divisor;
+			return (Dividend % Divisor != 0 && (Dividend < 0) != (Divisor < 0)) ? Quotient - 1 : Quotient;
+		}
+	}
+}
+
+FUSDTimeMapping::FUSDTimeMapping(double TimeCodesPerSecond, const FFrameRate& InTickResolution)
+	: TimeCodeRate(ToFrameRate(TimeCodesPerSecond > 0.0 ? TimeCodesPerSecond : 24.0))
+	, TickResolution(InTickResolution)
+{
+	// Ticks per time code = (TickNumerator / TickDenominator) / (RateNumerator / RateDenominator)
+	TicksNumerator = static_cast<int64>(TickResolution.Numerator) * TimeCodeRate.Denominator;
+	TicksDenominator = static_cast<int64>(TickResolution.Denominator) * TimeCodeRate.Numerator;
+
+	const int64 Divisor = USDTimeMapping::Private::GreatestCommonDivisor(TicksNumerator, TicksDenominator);
+	if (Divisor > 1)
+	{
+		TicksNumerator /= Divisor;
+		TicksDenominator /= Divisor;
+	}
+}
+
+FUSDTimeMapping FUSDTimeMapping::FromStage(const UE::FUsdStage& Stage, const FFrameRate& TickResolution)
+{
+	return FUSDTimeMapping(Stage ? Stage.GetTimeCodesPerSecond() : 24.0, TickResolution);
+}
+
+FFrameRate FUSDTimeMapping::ToFrameRate(double Rate)
+{
+	const FFrameRate NTSCRates[] = { FFrameRate(24000, 1001), FFrameRate(30000, 1001), FFrameRate(48000, 1001), FFrameRate(60000, 1001) };
+	for (const FFrameRate& NTSCRate : NTSCRates)
+	{
+		if (FMath::IsNearlyEqual(Rate, NTSCRate.AsDecimal(), 0.001))
+		{
+			return NTSCRate;
+		}
+	}
+
+	// Anything else is taken to the thousandth, which covers integer and half rates exactly
+	int64 Numerator = FMath::RoundToInt64(Rate * 1000.0);
+	int64 Denominator = 1000;
+	const int64 Divisor = USDTimeMapping::Private::GreatestCommonDivisor(Numerator, Denominator);
+	if (Divisor > 1)
+	{
+		Numerator /= Divisor;
+		Denominator /= Divisor;
+	}
+	return FFrameRate(static_cast<int32>(Numerator), static_cast<int32>(Denominator));
+}
+
+FFrameTime FUSDTimeMapping::ToFrameTime(double TimeCode) const
+{
+	// The whole time codes go through integer math, only the fraction of a sub-frame sample is scaled as a double
+	const double WholeTimeCodes = FMath::FloorToDouble(TimeCode);
+	const double Fraction = TimeCode - WholeTimeCodes;
+
+	const int64 ScaledTicks = static_cast<int64>(WholeTimeCodes) * TicksNumerator;
+	int64 Ticks = USDTimeMapping::Private::FloorDivide(ScaledTicks, TicksDenominator);
+	const int64 Remainder = ScaledTicks - Ticks * TicksDenominator;
+
+	double SubTicks = (static_cast<double>(Remainder) + Fraction * static_cast<double>(TicksNumerator)) / static_cast<double>(TicksDenominator);
+	const double WholeSubTicks = FMath::FloorToDouble(SubTicks);
+	Ticks += static_cast<int64>(WholeSubTicks);
+	SubTicks -= WholeSubTicks;
+
+	return FFrameTime(FFrameNumber(static_cast<int32>(Ticks)), static_cast<float>(SubTicks));
+}
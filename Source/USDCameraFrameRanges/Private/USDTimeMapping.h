@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+#include "Misc/FrameTime.h"
+
+namespace UE
+{
+	class FUsdStage;
+}
+
+/**
+ * Converts USD time codes to Sequencer ticks, honoring the stage's timeCodesPerSecond.
+ * The ratio of ticks per time code is kept as a reduced integer fraction, so whole time codes map to ticks exactly
+ * however long the shot is, including at NTSC rates, and sub-frame samples keep their own tick.
+ */
+class FUSDTimeMapping
+{
+public:
+	FUSDTimeMapping(double TimeCodesPerSecond, const FFrameRate& InTickResolution);
+
+	/** Mapping for the time codes of Stage, 24 time codes per second if the stage is invalid */
+	static FUSDTimeMapping FromStage(const UE::FUsdStage& Stage, const FFrameRate& TickResolution);
+
+	/** Closest rational rate to a decimal one, recognizing the rounded values NTSC rates get authored with, e.g. 29.97 */
+	static FFrameRate ToFrameRate(double Rate);
+
+	/** Tick time of the time code, with the fraction of a tick as the sub-frame */
+	FFrameTime ToFrameTime(double TimeCode) const;
+
+	/** Tick nearest to the time code */
+	FFrameNumber ToTick(double TimeCode) const
+	{
+		return ToFrameTime(TimeCode).RoundToFrame();
+	}
+
+	const FFrameRate& GetTimeCodeRate() const
+	{
+		return TimeCodeRate;
+	}
+
+	const FFrameRate& GetTickResolution() const
+	{
+		return TickResolution;
+	}
+
+private:
+	FFrameRate TimeCodeRate;
+	FFrameRate TickResolution;
+
+	/** Ticks per time code is TicksNumerator / TicksDenominator */
+	int64 TicksNumerator = 1;
+	int64 TicksDenominator = 1;
+};
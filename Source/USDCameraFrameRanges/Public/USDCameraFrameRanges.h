@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/WeakObjectPtrTemplates.h"
 #include "UsdWrappers/UsdAttribute.h" // Necessary include for FUsdAttribute
 #include "UsdWrappers/SdfPath.h" // Necessary include for FSdfPath
 
@@ -14,21 +15,30 @@ namespace UE
 {
 	class FSdfPath;
 	class FUsdPrim;
+	class FUsdStage;
 	class FUsdAttribute;
 }
 
 class FToolBarBuilder;
 class FMenuBuilder;
 class AUsdStageActor;
+class ULevelSequence;
+class UPackage;
+struct FCameraBakeData;
+struct FCameraKeyReductionSettings;
+class FUSDStageIndex;
+class FUSDCameraStore;
+struct FUSDCameraRecord;
+class FUSDCameraLivePreview;
+struct FAssetData;
+struct FStreamableHandle;
 
 struct FCameraInfo
 {
 	FString CameraName;
-	UE::FSdfPath* PrimPath;
-	UE::FUsdAttribute Translation;
-	UE::FUsdAttribute Rotation;
-	TArray<double> RotTimeSamples;
-	TArray<double> TransTimeSamples;
+	UE::FSdfPath PrimPath;
+	/** Sorted, unique times of every xformOp sample of the camera and of the ancestors it inherits a transform from */
+	TArray<double> TimeSamples;
 	int32 StartFrame;
 	int32 EndFrame;
 };
@@ -39,6 +49,8 @@ struct FMaterialInfo
 	FString MatName;
 	bool bMatchFound=false;
 	UE::FSdfPath PrimPath;
+	/** The material resolved for PrimPath, which may be bound on one of its ancestors or through a collection */
+	UE::FSdfPath MaterialPath;
 		
 };
 
@@ -57,22 +69,74 @@ private:
 
 	void RegisterMenus();
 
-	TObjectPtr<AUsdStageActor> GetUsdStageActor();
-	TArray<FCameraInfo> GetCamerasFromUSDStage(TObjectPtr<AUsdStageActor> USDStageActor);
+	/** Every stage actor of the editor world, e.g. separate layout, animation and set stages, ordered by label */
+	TArray<TObjectPtr<AUsdStageActor>> GetUsdStageActors();
+	TSharedRef<const FUSDCameraStore> GetCamerasFromUSDStage(TObjectPtr<AUsdStageActor> USDStageActor);
 	// TArray<FCameraInfo> GetCamerasFromUSDStage();
 	
-	void TraverseAndCollectCameras(UE::FUsdPrim& CurrentPrim, TArray<UE::FSdfPath>& OutCameraPaths);
-	// void FUSDCameraFrameRangesModule::TraverseAndCollectCameras(const UE::FUsdPrim& CurrentPrim,
-	// TArray<UE::FSdfPath>& OutCameraPaths, TArray<AActor*>& CineCameraActors, TArray<ACineCameraActor*>& OutCameraActors);
-	void TraverseAndCollectMaterials(TObjectPtr<AUsdStageActor> StageActor, UE::FUsdPrim& CurrentPrim, TArray<FMaterialInfo>& MaterialNames);
+	/**
+	 * Index of the cameras and material bindings of the actor's stage, created on first use and kept up to date by USD
+	 * notices. Every stage has its own, so editing one stage never rescans the others
+	 */
+	FUSDStageIndex& GetStageIndex(TObjectPtr<AUsdStageActor> StageActor);
 
 	TSharedRef<class SDockTab> OnSpawnPluginTab(const class FSpawnTabArgs& SpawnTabArgs);
-	FReply OnDuplicateButtonClicked(TObjectPtr<AUsdStageActor> StageActor, FCameraInfo Camera, FString LevelSequencePath);
+	/** Fills the tab with the cameras of every stage, scanning those that aren't indexed yet first */
+	void ShowStages(TSharedRef<class SDockTab> Tab);
+	/** Shows scan progress in the tab while the stages get indexed concurrently on worker threads, then shows them */
+	void StartStageScan(TSharedRef<class SDockTab> Tab, const TArray<TObjectPtr<AUsdStageActor>>& StageActors);
+	/** Camera lists grouped by stage, sharing the level sequence path */
+	TSharedRef<class SWidget> BuildCameraListContent(const TArray<TObjectPtr<AUsdStageActor>>& StageActors);
+	TSharedRef<class SWidget> BuildStageContent(TObjectPtr<AUsdStageActor> StageActor, TSharedRef<const FUSDCameraStore> Cameras,
+		TSharedRef<class SEditableTextBox> InputTextBox);
+	FReply OnDuplicateButtonClicked(TObjectPtr<AUsdStageActor> StageActor, const FUSDCameraStore& Cameras, const FUSDCameraRecord& Camera,
+		FString LevelSequencePath);
+	FReply OnDuplicateCamerasButtonClicked(TObjectPtr<AUsdStageActor> StageActor, const FUSDCameraStore& Cameras,
+		TArrayView<const FUSDCameraRecord* const> CamerasToDuplicate, FString LevelSequencePath);
 	FReply OnMaterialSwapButtonClicked(TObjectPtr<AUsdStageActor> StageActor);
-	TArray<UMaterial*>* GetAllMaterials();
+	/** Starts a live preview of the camera, or stops it if that camera is the one being previewed */
+	void TogglePreview(TObjectPtr<AUsdStageActor> StageActor, TSharedRef<const FUSDCameraStore> Cameras, const FUSDCameraRecord& Camera);
+	/** Asset data of every material and material instance under /Game/Materials, without loading any of them */
+	TArray<FAssetData> GetAllMaterials();
 
-	void AddCameraToLevelSequence(FString LevelSequencePath, TObjectPtr<ACineCameraActor> CameraActor, TObjectPtr<AUsdStageActor> StageActor, FCameraInfo Camera);
+	/**
+	 * Converts the USD samples of every camera in parallel, then spawns the duplicates and bakes each into a shot of its
+	 * own placed on the master sequence at LevelSequencePath, all in one transaction. The master and shots are created
+	 * as needed and every touched sequence is saved in one batch
+	 */
+	void DuplicateCameras(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras, TArrayView<const FUSDCameraRecord* const> CamerasToDuplicate,
+		const FString& LevelSequencePath);
+	/**
+	 * Spawns a duplicate of each baked camera and bakes it into its shot on MasterSequence, which may be null to only
+	 * spawn the actors. Meant to run inside the caller's transaction, the touched shots are added to OutPackagesToSave
+	 * for the caller to save along with the master
+	 */
+	void SpawnDuplicates(const UE::FUsdStage& Stage, ULevelSequence* MasterSequence, TArrayView<FCameraBakeData> BakeData,
+		const FCameraKeyReductionSettings& Reduction, TArray<UPackage*>& OutPackagesToSave);
+	/**
+	 * Brings the shots a previous DuplicateCameras baked up to date with the stage, only rewriting the keys over the
+	 * frames that changed. Cameras without a shot, or whose lens tracks no longer match, are duplicated again instead,
+	 * in the same transaction and save batch
+	 */
+	void ResyncCameras(const UE::FUsdStage& Stage, const FUSDCameraStore& Cameras, TArrayView<const FUSDCameraRecord* const> CamerasToResync,
+		const FString& LevelSequencePath);
+	/** Level sequence at PackageName from the cache, loaded or created as needed */
+	ULevelSequence* FindOrCreateSequence(const FString& PackageName, bool& bOutCreated);
+	/** @return Binding of the camera actor, invalid if it couldn't be bound */
+	FGuid AddCameraToLevelSequence(ULevelSequence* LevelSequence, TObjectPtr<ACineCameraActor> CameraActor, FCameraBakeData& BakeData,
+		const FCameraKeyReductionSettings& Reduction);
 
 private:
 	TSharedPtr<class FUICommandList> PluginCommands;
+
+	TMap<TWeakObjectPtr<AUsdStageActor>, TSharedPtr<FUSDStageIndex>> StageIndices;
+
+	/** Master sequences by package name, so clicks after the first don't resolve the path again */
+	TMap<FString, TWeakObjectPtr<ULevelSequence>> SequenceCache;
+
+	/** Only one camera is previewed at a time */
+	TSharedPtr<FUSDCameraLivePreview> LivePreview;
+
+	/** Keeps the materials matched by the last swap loading, released by the next swap */
+	TSharedPtr<FStreamableHandle> MaterialLoadHandle;
 };
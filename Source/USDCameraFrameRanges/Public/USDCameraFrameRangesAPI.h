@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "USDCameraFrameRanges.h"
+#include "UsdWrappers/UsdStage.h"
+
+class ULevelSequence;
+
+/**
+ * Camera extraction working directly on a UE::FUsdStage, without a stage actor and without importing anything.
+ * None of these keep state between calls.
+ */
+namespace USDCameraFrameRanges
+{
+	/**
+	 * Opens the stage in memory, outside of the stage cache. Payloads hold most of the geometry of a shot and none of
+	 * its cameras, so they are left unloaded unless asked for.
+	 * @return An invalid stage if the file couldn't be opened
+	 */
+	USDCAMERAFRAMERANGES_API UE::FUsdStage OpenStage(const FString& FilePath, bool bLoadPayloads = false);
+
+	/** Every camera of the stage with its frame range. Only reads USD data, so it can run on any thread */
+	USDCAMERAFRAMERANGES_API TArray<FCameraInfo> GetCameras(const UE::FUsdStage& Stage);
+
+	/** The material resolved for every piece of geometry of the stage that has one. Only reads USD data, so it can run on any thread */
+	USDCAMERAFRAMERANGES_API TArray<FMaterialInfo> GetMaterialBindings(const UE::FUsdStage& Stage);
+
+	/**
+	 * Bakes the cameras into the sequence as spawnable CineCameraActors, replacing those of a previous bake, and sets
+	 * the playback range to cover them. The USD samples of every camera are converted in parallel. Game thread only
+	 * @return Number of cameras baked
+	 */
+	USDCAMERAFRAMERANGES_API int32 BakeCameras(const UE::FUsdStage& Stage, const TArray<FCameraInfo>& Cameras, ULevelSequence& LevelSequence);
+}
@@ -26,6 +26,7 @@ public class USDCameraFrameRanges : ModuleRules
 			new string[]
 			{
 				"Core",
+				"UnrealUSDWrapper",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -44,13 +45,13 @@ public class USDCameraFrameRanges : ModuleRules
 				"Slate",
 				"SlateCore",
 				"USDStage",
-				"UnrealUSDWrapper",
 				"USDUtilities",
 				"CinematicCamera",
 				"Boost", 
 				"MovieScene",
 				"MovieSceneTracks",
 				"LevelSequence",
+				"Json",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);